@@ -0,0 +1,129 @@
+/**
+ * @file hub_benchmark.h
+ * @brief Cycle-counted micro-benchmark harness for the on-target benchmark build ([env:bench]).
+ *
+ * Features / design notes:
+ * - Each call is timed individually with the CPU cycle counter (esp_cpu_get_cycle_count() on
+ *   ESP-IDF 5, ESP.getCycleCount() before that); the cost of reading the counter is measured
+ *   once and subtracted.
+ * - Reports min / median / p99 / max cycles per call and the free-heap delta per call
+ *   (positive = bytes retained per call, i.e. a leak or a growing cache).
+ * - Output is one JSON object per line, so a host script can diff two runs release to release.
+ *   Lines: {"type":"meta",...}, {"type":"result",...}, {"type":"skip",...}, {"type":"done",...}.
+ * - Interrupts stay enabled: min and median are stable, p99 / max include ISR and task jitter.
+ */
+
+#ifndef HUB_BENCHMARK_H
+#define HUB_BENCHMARK_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include "memory_utils.hpp"
+
+#if !defined(ARDUINO_ARCH_ESP32)
+#error "The benchmark build needs the ESP32 cycle counter"
+#endif
+
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_cpu.h>
+#endif
+
+namespace HubBenchmark {
+
+    static const uint32_t kMaxSamples = 1000;
+
+    struct Result {
+        uint32_t iterations;
+        uint32_t minCycles;
+        uint32_t medianCycles;
+        uint32_t p99Cycles;
+        uint32_t maxCycles;
+        float heapDeltaPerCall;  // Bytes of free heap lost per call
+    };
+
+    inline uint32_t cycles() {
+        #if ESP_IDF_VERSION_MAJOR >= 5
+        return esp_cpu_get_cycle_count();
+        #else
+        return ESP.getCycleCount();
+        #endif
+    }
+
+    // Cycles spent reading the counter twice with nothing in between (minimum of several tries)
+    inline uint32_t timerOverhead() {
+        static uint32_t overhead = UINT32_MAX;
+        if (overhead == UINT32_MAX) {
+            for (uint8_t i = 0; i < 32; i++) {
+                const uint32_t start = cycles();
+                const uint32_t elapsed = cycles() - start;
+                if (elapsed < overhead) overhead = elapsed;
+            }
+        }
+        return overhead;
+    }
+
+    /**
+     * @brief Times fn() iterations times (after warmup untimed calls).
+     * @param fn Callable run once per sample
+     * @param iterations Timed calls, clamped to kMaxSamples
+     * @param warmup Untimed calls first, to fill caches and reach steady state
+     */
+    template <typename Fn>
+    Result run(Fn fn, uint32_t iterations = 500, uint32_t warmup = 20) {
+        static uint32_t samples[kMaxSamples];
+        if (iterations == 0) iterations = 1;
+        if (iterations > kMaxSamples) iterations = kMaxSamples;
+
+        for (uint32_t i = 0; i < warmup; i++) {
+            fn();
+        }
+
+        const uint32_t overhead = timerOverhead();
+        const uint32_t heapBefore = HubMemoryUtils::freeRam();
+        for (uint32_t i = 0; i < iterations; i++) {
+            const uint32_t start = cycles();
+            fn();
+            const uint32_t elapsed = cycles() - start;
+            samples[i] = elapsed > overhead ? elapsed - overhead : 0;
+        }
+        const uint32_t heapAfter = HubMemoryUtils::freeRam();
+
+        std::sort(samples, samples + iterations);
+        Result result;
+        result.iterations = iterations;
+        result.minCycles = samples[0];
+        result.medianCycles = samples[iterations / 2];
+        result.p99Cycles = samples[std::min(iterations - 1, (iterations * 99) / 100)];
+        result.maxCycles = samples[iterations - 1];
+        result.heapDeltaPerCall = (static_cast<float>(heapBefore) - static_cast<float>(heapAfter)) / iterations;
+        return result;
+    }
+
+    inline void reportMeta(Print& out, const char* libraryVersion) {
+        out.printf("{\"type\":\"meta\",\"library\":\"hub-robot-core\",\"version\":\"%s\",\"idf\":\"%s\","
+                   "\"cpu_mhz\":%u,\"timer_overhead\":%u,\"free_heap\":%u}\n",
+                   libraryVersion, esp_get_idf_version(), static_cast<unsigned>(getCpuFrequencyMhz()),
+                   static_cast<unsigned>(timerOverhead()), static_cast<unsigned>(HubMemoryUtils::freeRam()));
+    }
+
+    inline void report(Print& out, const char* name, const Result& r) {
+        out.printf("{\"type\":\"result\",\"name\":\"%s\",\"iters\":%u,\"min\":%u,\"median\":%u,\"p99\":%u,"
+                   "\"max\":%u,\"heap_delta\":%.2f}\n",
+                   name, static_cast<unsigned>(r.iterations), static_cast<unsigned>(r.minCycles),
+                   static_cast<unsigned>(r.medianCycles), static_cast<unsigned>(r.p99Cycles),
+                   static_cast<unsigned>(r.maxCycles), r.heapDeltaPerCall);
+    }
+
+    inline void reportSkip(Print& out, const char* name, const char* reason) {
+        out.printf("{\"type\":\"skip\",\"name\":\"%s\",\"reason\":\"%s\"}\n", name, reason);
+    }
+
+    inline void reportDone(Print& out, uint16_t results, uint16_t skipped) {
+        out.printf("{\"type\":\"done\",\"results\":%u,\"skipped\":%u}\n",
+                   static_cast<unsigned>(results), static_cast<unsigned>(skipped));
+    }
+
+} // namespace HubBenchmark
+
+#endif // HUB_BENCHMARK_H
@@ -0,0 +1,234 @@
+/**
+ * @file main.cpp
+ * @brief On-target benchmark run of the library's hot paths (build and flash with `pio run -e bench -t upload`).
+ *
+ * Results are printed once after boot as JSON lines (see hub_benchmark.h); capture them with
+ * `pio device monitor -e bench` and compare runs release to release.
+ *
+ * Pins default to the usage-guide examples and can be overridden with -D flags in [env:bench].
+ * Nothing needs to be wired for the GPIO benchmarks; the I2C drivers are skipped when the
+ * device does not ACK.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+
+#include "hub_benchmark.h"
+#include "shift_register.h"
+#include "fixed_shift_register.h"
+#include "dc_motor.h"
+#include "button.h"
+#include "serial_proxy.hpp"
+#include "string_utils.hpp"
+#include "i2c_utils.hpp"
+#include "ads7828/i2c_adc_ads7828.h"
+#include "LIS3DH/SparkFunLIS3DH.h"
+
+#ifndef BENCH_LIBRARY_VERSION
+#define BENCH_LIBRARY_VERSION "0.2.0"
+#endif
+#ifndef BENCH_SR_DATA_PIN
+#define BENCH_SR_DATA_PIN 11
+#endif
+#ifndef BENCH_SR_CLOCK_PIN
+#define BENCH_SR_CLOCK_PIN 12
+#endif
+#ifndef BENCH_SR_LATCH_PIN
+#define BENCH_SR_LATCH_PIN 10
+#endif
+#ifndef BENCH_MOTOR_EN_PIN
+#define BENCH_MOTOR_EN_PIN 16
+#endif
+#ifndef BENCH_MOTOR_IN1_PIN
+#define BENCH_MOTOR_IN1_PIN 17
+#endif
+#ifndef BENCH_MOTOR_IN2_PIN
+#define BENCH_MOTOR_IN2_PIN 18
+#endif
+#ifndef BENCH_BUTTON_PIN
+#define BENCH_BUTTON_PIN 5
+#endif
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 500
+#endif
+
+using HubBenchmark::Result;
+
+namespace {
+
+    // Print sink that discards everything (tail() target)
+    class NullPrint : public Print {
+        public:
+            size_t write(uint8_t) override { return 1; }
+            size_t write(const uint8_t*, size_t size) override { return size; }
+    };
+
+    // Keeps results observable so the optimizer cannot drop the benchmarked call
+    volatile uint32_t sink;
+
+    uint16_t results = 0;
+    uint16_t skipped = 0;
+
+    template <typename Fn>
+    void bench(const char* name, Fn fn, uint32_t iterations = BENCH_ITERATIONS) {
+        const Result r = HubBenchmark::run(fn, iterations);
+        HubBenchmark::report(Serial, name, r);
+        results++;
+    }
+
+    void skip(const char* name, const char* reason) {
+        HubBenchmark::reportSkip(Serial, name, reason);
+        skipped++;
+    }
+
+    const char kCsvLine[] = "12.5,  -3.0 ,7,,ok, 0x1F,255,temp01,  42  ,end";
+    const char kUtf8Text[] =
+        "Robot \xE2\x9C\x93 status: \xE6\xB8\xA9\xE5\xBA\xA6 21.5\xC2\xB0" "C, bat 87% \xF0\x9F\x94\x8B "
+        "links ok; motors idle; sensors nominal; uptime 3d 04:12:55; heap ok - "
+        "Robot \xE2\x9C\x93 status: \xE6\xB8\xA9\xE5\xBA\xA6 21.5\xC2\xB0" "C, bat 87% \xF0\x9F\x94\x8B "
+        "links ok; motors idle; sensors nominal; uptime 3d 04:12:55; heap ok - end of line";
+
+    void benchShiftRegisters() {
+        {
+            ShiftRegister reg(BENCH_SR_DATA_PIN, BENCH_SR_CLOCK_PIN, BENCH_SR_LATCH_PIN, 1);
+            uint8_t v = 0;
+            bench("shift_register.update.1x.digitalwrite", [&]() { reg.setValue(++v); reg.push_updates(true); });
+        }
+        {
+            ShiftRegister reg(BENCH_SR_DATA_PIN, BENCH_SR_CLOCK_PIN, BENCH_SR_LATCH_PIN, 8);
+            uint64_t v = 0;
+            bench("shift_register.update.8x.digitalwrite", [&]() { reg.setValue(++v); reg.push_updates(true); });
+            if (reg.useFastGPIO()) {
+                bench("shift_register.update.8x.fastgpio", [&]() { reg.setValue(++v); reg.push_updates(true); });
+            } else {
+                skip("shift_register.update.8x.fastgpio", "backend unavailable");
+            }
+            if (reg.useSPI(SPI, 20000000)) {
+                bench("shift_register.update.8x.spi", [&]() { reg.setValue(++v); reg.push_updates(true); });
+            } else {
+                skip("shift_register.update.8x.spi", "backend unavailable");
+            }
+            bench("shift_register.set.deferred", [&]() { reg.set(static_cast<uint8_t>(v++ & 63), true, false); });
+        }
+        {
+            FixedShiftRegister<1, BENCH_SR_DATA_PIN, BENCH_SR_CLOCK_PIN, BENCH_SR_LATCH_PIN> reg;
+            uint8_t v = 0;
+            bench("fixed_shift_register.update.1x", [&]() { reg.setValue(++v); reg.push_updates(true); });
+        }
+        {
+            FixedShiftRegister<8, BENCH_SR_DATA_PIN, BENCH_SR_CLOCK_PIN, BENCH_SR_LATCH_PIN> reg;
+            uint64_t v = 0;
+            bench("fixed_shift_register.update.8x", [&]() { reg.setValue(++v); reg.push_updates(true); });
+        }
+    }
+
+    void benchMotor() {
+        DCMotor motor(BENCH_MOTOR_EN_PIN, BENCH_MOTOR_IN1_PIN, BENCH_MOTOR_IN2_PIN);
+        int speed = 0;
+        // Alternate sign and magnitude so the redundancy check never short-circuits the update
+        bench("dc_motor.set_speed", [&]() { speed = (speed > 0) ? -(speed % 200) - 40 : -speed + 17; motor.setSpeed(speed); });
+        bench("dc_motor.set_speed.unchanged", [&]() { motor.setSpeed(speed); });
+        motor.setSpeed(0);
+    }
+
+    void benchButton() {
+        Button button(BENCH_BUTTON_PIN, 25, false);
+        bench("button.tick.idle", [&]() { button.tick(); }, 1000);
+    }
+
+    void benchSerialProxy() {
+        SerialProxy proxy(4096);
+        proxy.setMirrorMode(SerialMirrorMode::ASYNC);  // Buffer only; Serial carries the results
+        static const char line[] = "[12345] motor: speed=150 target=200 rpm=1432 temp=41C\n";
+        NullPrint nullPrint;
+        bench("serial_proxy.write.64b", [&]() { sink = proxy.write(line, sizeof(line) - 1); });
+        bench("serial_proxy.tail.print.20", [&]() { sink = proxy.tail(nullPrint, 20); });
+        bench("serial_proxy.tail.string.20", [&]() { sink = proxy.tail(20).length(); }, 200);
+    }
+
+    void benchStrings() {
+        const String csv(kCsvLine);
+        const std::string csvStd(kCsvLine);
+        const String padded("   \t  some padded value with spaces \r\n");
+        const size_t utf8Len = sizeof(kUtf8Text) - 1;
+
+        bench("string.split.string", [&]() { sink = HubStringUtils::split(csv, ',').size(); });
+        bench("string.split.std", [&]() { sink = HubStringUtils::split(csvStd, ',').size(); });
+        bench("string.split_view", [&]() {
+            uint32_t n = 0;
+            for (HubStringUtils::StringView token : HubStringUtils::splitView(csv, ',')) n += token.length;
+            sink = n;
+        });
+        {
+            std::vector<String> reused;
+            reused.reserve(16);
+            bench("string.split_into.reused", [&]() { reused.clear(); sink = HubStringUtils::splitInto(csv, ',', reused); });
+        }
+        bench("string.trim.string", [&]() { sink = HubStringUtils::trim(padded).length(); });
+        bench("string.trim_view", [&]() { sink = HubStringUtils::trimView(padded).length; });
+        bench("string.utf8_char_count", [&]() { sink = HubStringUtils::utf8CharCount(kUtf8Text, utf8Len); });
+        bench("string.utf8_validate", [&]() { sink = HubStringUtils::utf8Validate(kUtf8Text, utf8Len); });
+    }
+
+    void benchAds7828() {
+        I2CBus& bus = I2CBus::primary();
+        if (bus.probe(0x48) != 0) {
+            skip("ads7828.update_all", "no device at 0x48");
+            return;
+        }
+        ADS7828::begin(bus);
+        static ADS7828 adc(0);
+        bench("ads7828.update_all", [&]() { sink = ADS7828::updateAll(); }, 200);
+        bench("ads7828.update.single_channel", [&]() { sink = adc.update(static_cast<uint8_t>(0)); }, 200);
+    }
+
+    void benchLis3dh() {
+        I2CBus& bus = I2CBus::primary();
+        if (bus.probe(0x19) != 0) {
+            skip("lis3dh.read_raw_xyz", "no device at 0x19");
+            skip("lis3dh.fifo_read", "no device at 0x19");
+            return;
+        }
+        static LIS3DH imu(I2C_MODE, 0x19);
+        imu.setI2CBus(bus);
+        imu.settings.fifoEnabled = 1;
+        imu.settings.fifoMode = 0x2;  // Stream
+        if (imu.begin() != IMU_SUCCESS) {
+            skip("lis3dh.read_raw_xyz", "begin failed");
+            skip("lis3dh.fifo_read", "begin failed");
+            return;
+        }
+        int16_t xyz[3];
+        bench("lis3dh.read_raw_xyz", [&]() { sink = imu.readRawAccelXYZ(xyz); }, 200);
+        bench("lis3dh.read_float_x", [&]() { sink = static_cast<uint32_t>(imu.readFloatAccelX() * 1000.0f); }, 200);
+
+        imu.fifoBegin();
+        imu.fifoStartRec();
+        static int16_t fifo[32][3];
+        bench("lis3dh.fifo_read", [&]() { sink = imu.fifoRead(fifo, 32); }, 200);
+        imu.fifoEnd();
+    }
+
+} // namespace
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000);  // Give the monitor time to attach
+
+    I2CBus::primary().begin();
+
+    HubBenchmark::reportMeta(Serial, BENCH_LIBRARY_VERSION);
+    benchShiftRegisters();
+    benchMotor();
+    benchButton();
+    benchSerialProxy();
+    benchStrings();
+    benchAds7828();
+    benchLis3dh();
+    HubBenchmark::reportDone(Serial, results, skipped);
+}
+
+void loop() {
+    delay(1000);
+}
@@ -32,9 +32,27 @@ Distributed as-is; no warranty is given.
 
 #include "SparkFunLIS3DH.h"
 #include "stdint.h"
+#include "string.h"
 
 #include "Wire.h"
 #include "SPI.h"
+#include "../i2c_utils.hpp"
+
+//Size of the Wire receive buffer, which bounds a single I2C region read
+#if defined(I2C_BUFFER_LENGTH)
+#define LIS3DH_I2C_MAX_READ I2C_BUFFER_LENGTH
+#elif defined(BUFFER_LENGTH)
+#define LIS3DH_I2C_MAX_READ BUFFER_LENGTH
+#else
+#define LIS3DH_I2C_MAX_READ 32
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+//CTRL_REG3 bit routing the FIFO watermark to INT1
+#define LIS3DH_CTRL_REG3_I1_WTM 0x04
 
 //****************************************************************************//
 //
@@ -52,7 +70,7 @@ Distributed as-is; no warranty is given.
 //  Default construction is I2C mode, address 0x6B.
 //
 //****************************************************************************//
-LIS3DHCore::LIS3DHCore( uint8_t busType, uint8_t inputArg ) : commInterface(I2C_MODE), I2CAddress(0x19), chipSelectPin(10)
+LIS3DHCore::LIS3DHCore( uint8_t busType, uint8_t inputArg ) : commInterface(I2C_MODE), I2CAddress(0x19), chipSelectPin(10), i2cBus(nullptr)
 {
 	commInterface = busType;
 	if( commInterface == I2C_MODE )
@@ -73,7 +91,14 @@ status_t LIS3DHCore::beginCore(void)
 	switch (commInterface) {
 
 	case I2C_MODE:
-		Wire.begin();
+		if( i2cBus )
+		{
+			i2cBus->begin();
+		}
+		else
+		{
+			Wire.begin();
+		}
 		break;
 
 	case SPI_MODE:
@@ -146,6 +171,19 @@ status_t LIS3DHCore::beginCore(void)
 
 }
 
+//****************************************************************************//
+//
+//  setI2CBus
+//
+//  Parameters:
+//    bus -- shared bus manager to use for I2C_MODE transactions
+//
+//****************************************************************************//
+void LIS3DHCore::setI2CBus( I2CBus& bus )
+{
+	i2cBus = &bus;
+}
+
 //****************************************************************************//
 //
 //  ReadRegisterRegion
@@ -173,6 +211,15 @@ status_t LIS3DHCore::readRegisterRegion(uint8_t *outputPointer , uint8_t offset,
 	switch (commInterface) {
 
 	case I2C_MODE:
+		if( i2cBus )
+		{
+			offset |= 0x80; //turn auto-increment bit on, bit 7 for I2C
+			if( i2cBus->writeRead(I2CAddress, &offset, 1, outputPointer, length) != 0 )
+			{
+				returnError = IMU_HW_ERROR;
+			}
+			break;
+		}
 		Wire.beginTransmission(I2CAddress);
 		offset |= 0x80; //turn auto-increment bit on, bit 7 for I2C
 		Wire.write(offset);
@@ -245,6 +292,15 @@ status_t LIS3DHCore::readRegister(uint8_t* outputPointer, uint8_t offset) {
 	switch (commInterface) {
 
 	case I2C_MODE:
+		if( i2cBus )
+		{
+			result = 0;
+			if( i2cBus->writeRead(I2CAddress, &offset, 1, &result, numBytes) != 0 )
+			{
+				returnError = IMU_HW_ERROR;
+			}
+			break;
+		}
 		Wire.beginTransmission(I2CAddress);
 		Wire.write(offset);
 		if( Wire.endTransmission() != 0 )
@@ -305,6 +361,24 @@ status_t LIS3DHCore::readRegisterInt16( int16_t* outputPointer, uint8_t offset )
 
 }
 
+//****************************************************************************//
+//
+//  maxRegionLength
+//
+//  Returns the largest number of bytes readRegisterRegion can move in one
+//  transaction.  SPI is only limited by the length argument; I2C is limited
+//  by the Wire receive buffer.
+//
+//****************************************************************************//
+uint8_t LIS3DHCore::maxRegionLength( void )
+{
+	if( commInterface == I2C_MODE )
+	{
+		return (LIS3DH_I2C_MAX_READ > 255) ? 255 : LIS3DH_I2C_MAX_READ;
+	}
+	return 255;
+}
+
 //****************************************************************************//
 //
 //  writeRegister
@@ -318,6 +392,15 @@ status_t LIS3DHCore::writeRegister(uint8_t offset, uint8_t dataToWrite) {
 	status_t returnError = IMU_SUCCESS;
 	switch (commInterface) {
 	case I2C_MODE:
+		if( i2cBus )
+		{
+			uint8_t data[2] = { offset, dataToWrite };
+			if( i2cBus->write(I2CAddress, data, 2) != 0 )
+			{
+				returnError = IMU_HW_ERROR;
+			}
+			break;
+		}
 		//Write the byte
 		Wire.beginTransmission(I2CAddress);
 		Wire.write(offset);
@@ -381,6 +464,12 @@ LIS3DH::LIS3DH( uint8_t busType, uint8_t inputArg ) : LIS3DHCore( busType, input
 	allOnesCounter = 0;
 	nonSuccessCounter = 0;
 
+	watermarkPending = false;
+	watermarkPin = 0xFF;
+	watermarkRing = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+	watermarkTask = NULL;
+#endif
 }
 
 //****************************************************************************//
@@ -574,6 +663,49 @@ float LIS3DH::readFloatAccelZ( void )
 	return output;
 }
 
+//****************************************************************************//
+//
+//  readRawAccelXYZ
+//
+//  Reads all three axes as a single 6-byte region (OUT_X_L..OUT_Z_H) using
+//  the auto-increment bit, so one sample costs one bus transaction rather
+//  than three.
+//
+//  Parameters:
+//    out -- 3 element array to receive X, Y, Z (in that order)
+//
+//****************************************************************************//
+status_t LIS3DH::readRawAccelXYZ( int16_t out[3] )
+{
+	uint8_t myBuffer[6] = { 0 };
+	status_t errorLevel = readRegisterRegion( myBuffer, LIS3DH_OUT_X_L, 6 );
+	if( errorLevel != IMU_SUCCESS )
+	{
+		if( errorLevel == IMU_ALL_ONES_WARNING )
+		{
+			allOnesCounter++;
+		}
+		else
+		{
+			nonSuccessCounter++;
+		}
+	}
+	out[0] = (int16_t)myBuffer[0] | int16_t(myBuffer[1] << 8);
+	out[1] = (int16_t)myBuffer[2] | int16_t(myBuffer[3] << 8);
+	out[2] = (int16_t)myBuffer[4] | int16_t(myBuffer[5] << 8);
+	return errorLevel;
+}
+
+status_t LIS3DH::readFloatAccelXYZ( float out[3] )
+{
+	int16_t raw[3];
+	status_t errorLevel = readRawAccelXYZ( raw );
+	out[0] = calcAccel(raw[0]);
+	out[1] = calcAccel(raw[1]);
+	out[2] = calcAccel(raw[2]);
+	return errorLevel;
+}
+
 float LIS3DH::calcAccel( int16_t input )
 {
 	float output;
@@ -668,13 +800,108 @@ void LIS3DH::fifoBegin( void )
 
 void LIS3DH::fifoClear( void ) {
 	//Drain the fifo data and dump it
-	while( (fifoGetStatus() & 0x20 ) == 0 ) {
-		readRawAccelX();
-		readRawAccelY();
-		readRawAccelZ();
+	int16_t scratch[LIS3DH_FIFO_DEPTH][3];
+	while( fifoRead( scratch, LIS3DH_FIFO_DEPTH ) > 0 ) {
 	}
 }
 
+//****************************************************************************//
+//
+//  fifoRead
+//
+//  Parameters:
+//    dst -- array of at least max XYZ triples to receive the samples
+//    max -- maximum number of samples to read
+//
+//  Reads the FSS count from FIFO_SRC_REG once, then reads the stored
+//  samples starting at OUT_X_L.  With auto-increment the address wraps from
+//  OUT_Z_H back to OUT_X_L while the FIFO is enabled, so each burst returns
+//  consecutive samples.  Bursts are sized to the bus limit (one burst for a
+//  full FIFO on SPI).
+//
+//  Returns the number of samples written to dst.
+//
+//****************************************************************************//
+size_t LIS3DH::fifoRead( int16_t (*dst)[3], size_t max )
+{
+	if( dst == 0 || max == 0 )
+	{
+		return 0;
+	}
+
+	uint8_t fifoSrc = 0;
+	status_t errorLevel = readRegister( &fifoSrc, LIS3DH_FIFO_SRC_REG );
+	if( errorLevel != IMU_SUCCESS )
+	{
+		if( errorLevel == IMU_ALL_ONES_WARNING )
+		{
+			allOnesCounter++;
+		}
+		else
+		{
+			nonSuccessCounter++;
+		}
+		return 0;
+	}
+	if( fifoSrc & 0x20 )
+	{
+		//EMPTY flag set
+		return 0;
+	}
+
+	size_t stored = fifoSrc & 0x1F;  //FSS
+	if( fifoSrc & 0x40 )
+	{
+		//OVRN_FIFO set, all slots are filled
+		stored = LIS3DH_FIFO_DEPTH;
+	}
+	if( stored > max )
+	{
+		stored = max;
+	}
+
+	size_t perBurst = maxRegionLength() / 6;
+	if( perBurst == 0 )
+	{
+		perBurst = 1;
+	}
+
+	size_t done = 0;
+	while( done < stored )
+	{
+		size_t count = stored - done;
+		if( count > perBurst )
+		{
+			count = perBurst;
+		}
+
+		//Read straight into the caller's buffer, then fix up byte order in place
+		uint8_t* bytes = reinterpret_cast<uint8_t*>( dst[done] );
+		errorLevel = readRegisterRegion( bytes, LIS3DH_OUT_X_L, count * 6 );
+		if( errorLevel != IMU_SUCCESS )
+		{
+			if( errorLevel == IMU_ALL_ONES_WARNING )
+			{
+				allOnesCounter++;
+			}
+			else
+			{
+				nonSuccessCounter++;
+				break;
+			}
+		}
+		for( size_t i = 0; i < count * 3; i++ )
+		{
+			uint8_t lsb = bytes[i * 2];
+			uint8_t msb = bytes[i * 2 + 1];
+			dst[done + i / 3][i % 3] = (int16_t)lsb | int16_t(msb << 8);
+		}
+		done += count;
+	}
+
+	return done;
+}
+
 void LIS3DH::fifoStartRec( void )
 {
 	uint8_t dataToWrite = 0;  //Temporary variable
@@ -724,3 +951,237 @@ void LIS3DH::fifoEnd( void )
 #endif
 	writeRegister(LIS3DH_FIFO_CTRL_REG, dataToWrite);	
 }
+
+
+//****************************************************************************//
+//
+//  Watermark interrupt section
+//
+//****************************************************************************//
+status_t LIS3DH::fifoWatermarkBegin( uint8_t int1Pin, LIS3DHSampleRing* ring )
+{
+	if( ring == 0 )
+	{
+		return IMU_GENERIC_ERROR;
+	}
+	if( watermarkRing != 0 )
+	{
+		fifoWatermarkEnd();
+	}
+
+	watermarkRing = ring;
+	watermarkPin = int1Pin;
+	//INT1 is level while the FIFO is above threshold, so an already-full FIFO
+	//  would never produce an edge.  Start pending so the first service drains.
+	watermarkPending = true;
+
+	//Route the watermark to INT1
+	uint8_t dataToWrite = 0;
+	readRegister( &dataToWrite, LIS3DH_CTRL_REG3 ); //Start with existing data
+	dataToWrite |= LIS3DH_CTRL_REG3_I1_WTM;
+#ifdef VERBOSE_SERIAL
+	Serial.print("LIS3DH_CTRL_REG3: 0x");
+	Serial.println(dataToWrite, HEX);
+#endif
+	status_t returnError = writeRegister(LIS3DH_CTRL_REG3, dataToWrite);
+
+	pinMode(int1Pin, INPUT);
+	attachInterruptArg(digitalPinToInterrupt(int1Pin), handleWatermarkInterrupt, this, RISING);
+
+	return returnError;
+}
+
+void LIS3DH::fifoWatermarkEnd( void )
+{
+	if( watermarkRing == 0 )
+	{
+		return;
+	}
+	detachInterrupt(digitalPinToInterrupt(watermarkPin));
+
+	uint8_t dataToWrite = 0;
+	readRegister( &dataToWrite, LIS3DH_CTRL_REG3 ); //Start with existing data
+	dataToWrite &= ~LIS3DH_CTRL_REG3_I1_WTM;
+	writeRegister(LIS3DH_CTRL_REG3, dataToWrite);
+
+	watermarkRing = 0;
+	watermarkPin = 0xFF;
+	watermarkPending = false;
+}
+
+bool LIS3DH::fifoWatermarkPending( void ) const
+{
+	return watermarkPending;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void LIS3DH::fifoWatermarkNotify( TaskHandle_t task )
+{
+	watermarkTask = task;
+}
+#endif
+
+//****************************************************************************//
+//
+//  fifoService
+//
+//  Deferred half of the watermark interrupt.  If a watermark is pending,
+//  drains the FIFO into the free span(s) of the ring until the FIFO reports
+//  empty.  If the ring fills first, or a read fails while INT1 is still
+//  asserted, the watermark is left pending so the next call resumes.
+//
+//  Returns the number of samples added to the ring.
+//
+//****************************************************************************//
+size_t LIS3DH::fifoService( void )
+{
+	if( watermarkRing == 0 || !watermarkPending )
+	{
+		return 0;
+	}
+	//Clear before draining so an edge that lands mid-drain is not lost
+	watermarkPending = false;
+
+	size_t total = 0;
+	while( true )
+	{
+		size_t room = 0;
+		LIS3DHSample* span = watermarkRing->writeSpan( &room );
+		if( room == 0 )
+		{
+			watermarkPending = true;
+			break;
+		}
+		size_t count = fifoRead( span, room );
+		if( count == 0 )
+		{
+			//Empty FIFO, or a bus error.  If INT1 is still high the FIFO is
+			//  still above threshold and no new RISING edge will come, so
+			//  keep the watermark pending for the next call to retry.
+			if( digitalRead( watermarkPin ) == HIGH )
+			{
+				watermarkPending = true;
+			}
+			break;
+		}
+		watermarkRing->commit( count );
+		total += count;
+	}
+	return total;
+}
+
+void IRAM_ATTR LIS3DH::handleWatermarkInterrupt( void* arg )
+{
+	LIS3DH* imu = static_cast<LIS3DH*>(arg);
+	imu->watermarkPending = true;
+#if defined(ARDUINO_ARCH_ESP32)
+	if( imu->watermarkTask != NULL )
+	{
+		BaseType_t woken = pdFALSE;
+		vTaskNotifyGiveFromISR( imu->watermarkTask, &woken );
+		if( woken == pdTRUE )
+		{
+			portYIELD_FROM_ISR();
+		}
+	}
+#endif
+}
+
+//****************************************************************************//
+//
+//  LIS3DHSampleRing
+//
+//  Parameters:
+//    storage -- caller-owned array of slots samples
+//    slots -- number of entries in storage (capacity is slots - 1)
+//
+//****************************************************************************//
+LIS3DHSampleRing::LIS3DHSampleRing( LIS3DHSample* storage, uint16_t slots ) : buffer(storage), size(slots), head(0), tail(0)
+{
+	if( buffer == 0 )
+	{
+		size = 0;
+	}
+}
+
+size_t LIS3DHSampleRing::capacity( void ) const
+{
+	return size > 0 ? size - 1 : 0;
+}
+
+size_t LIS3DHSampleRing::available( void ) const
+{
+	if( size == 0 )
+	{
+		return 0;
+	}
+	uint16_t h = head.load(std::memory_order_acquire);
+	uint16_t t = tail.load(std::memory_order_relaxed);
+	return (h >= t) ? (h - t) : (size - t + h);
+}
+
+size_t LIS3DHSampleRing::read( LIS3DHSample* dst, size_t max )
+{
+	if( size == 0 || dst == 0 )
+	{
+		return 0;
+	}
+	uint16_t h = head.load(std::memory_order_acquire);
+	uint16_t t = tail.load(std::memory_order_relaxed);
+
+	size_t done = 0;
+	while( done < max && t != h )
+	{
+		//Copy the contiguous run up to the write position or end of storage
+		size_t run = (h > t) ? (h - t) : (size - t);
+		if( run > max - done )
+		{
+			run = max - done;
+		}
+		memcpy( dst[done], buffer[t], run * sizeof(LIS3DHSample) );
+		done += run;
+		t += run;
+		if( t == size )
+		{
+			t = 0;
+		}
+	}
+	tail.store(t, std::memory_order_release);
+	return done;
+}
+
+void LIS3DHSampleRing::discard( void )
+{
+	tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+LIS3DHSample* LIS3DHSampleRing::writeSpan( size_t* contiguous )
+{
+	*contiguous = 0;
+	if( size == 0 )
+	{
+		return 0;
+	}
+	uint16_t h = head.load(std::memory_order_relaxed);
+	uint16_t t = tail.load(std::memory_order_acquire);
+	if( h >= t )
+	{
+		//Free up to the end of storage, minus the guard slot if tail is at 0
+		*contiguous = size - h - (t == 0 ? 1 : 0);
+	}
+	else
+	{
+		*contiguous = t - h - 1;
+	}
+	return &buffer[h];
+}
+
+void LIS3DHSampleRing::commit( size_t n )
+{
+	uint16_t h = head.load(std::memory_order_relaxed) + n;
+	if( h >= size )
+	{
+		h = 0;
+	}
+	head.store(h, std::memory_order_release);
+}
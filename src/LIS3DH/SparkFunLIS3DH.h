@@ -28,6 +28,16 @@ Distributed as-is; no warranty is given.
 #define __LIS3DH_IMU_H__
 
 #include "stdint.h"
+#include "stddef.h"
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+//Shared I2C bus manager (i2c_utils.hpp)
+class I2CBus;
 
 //values for commInterface
 #define I2C_MODE 0
@@ -59,6 +69,12 @@ public:
 	
 	status_t beginCore( void );
 	
+	//Route I2C transactions through a shared bus manager instead of the
+	//  global Wire.  Each register access then runs as one locked
+	//  transaction (repeated start for reads), so other tasks and drivers
+	//  can share the bus.  Call before begin().
+	void setI2CBus( I2CBus& );
+	
 	//The following utilities read and write to the IMU
 
 	//ReadRegisterRegion takes a uint8 array address as input and reads
@@ -75,11 +91,17 @@ public:
 	//Writes an 8-bit byte;
 	status_t writeRegister(uint8_t, uint8_t);
 	
+protected:
+	//Largest region (in bytes) that can be read in a single transaction on
+	//  the configured bus (limited by the Wire receive buffer for I2C)
+	uint8_t maxRegionLength( void );
+
 private:
 	//Communication stuff
 	uint8_t commInterface;
 	uint8_t I2CAddress;
 	uint8_t chipSelectPin;
+	I2CBus* i2cBus;
 };
 
 //This struct holds the settings the driver uses to do calculations
@@ -105,6 +127,42 @@ public:
 };
 
 
+//One FIFO sample: [0] = X, [1] = Y, [2] = Z
+typedef int16_t LIS3DHSample[3];
+
+//Single-producer/single-consumer ring of XYZ samples.
+//  The producer is LIS3DH::fifoService(), which bursts FIFO data straight
+//  into the free span of the ring.  The application is the consumer and
+//  calls available()/read() without any locking.  Storage is supplied by
+//  the caller; one slot is kept free to tell full from empty.
+
+class LIS3DHSampleRing
+{
+public:
+	LIS3DHSampleRing( LIS3DHSample* storage, uint16_t slots );
+
+	//Consumer side
+	size_t available( void ) const;
+	size_t read( LIS3DHSample* dst, size_t max );
+	void discard( void );
+
+	//Usable capacity in samples (slots - 1)
+	size_t capacity( void ) const;
+
+private:
+	friend class LIS3DH;
+
+	//Producer side: contiguous free span starting at the write position,
+	//  then publish n samples written into it
+	LIS3DHSample* writeSpan( size_t* contiguous );
+	void commit( size_t n );
+
+	LIS3DHSample* buffer;
+	uint16_t size;
+	std::atomic<uint16_t> head;  //written only by the producer
+	std::atomic<uint16_t> tail;  //written only by the consumer
+};
+
 //This is the highest level class of the driver.
 //
 //  class LIS3DH inherits the core and makes use of the beginCore()
@@ -135,11 +193,18 @@ public:
 	int16_t readRawAccelY( void );
 	int16_t readRawAccelZ( void );
 
+	//Reads X, Y and Z in one auto-increment burst (OUT_X_L..OUT_Z_H).
+	//  out[0] = X, out[1] = Y, out[2] = Z.  Returns the bus status.
+	status_t readRawAccelXYZ( int16_t out[3] );
+
 	//Returns the values as floats.  Inside, this calls readRaw___();
 	float readFloatAccelX( void );
 	float readFloatAccelY( void );
 	float readFloatAccelZ( void );
 
+	//Float variant of readRawAccelXYZ(), converted with calcAccel()
+	status_t readFloatAccelXYZ( float out[3] );
+
 	//ADC related calls
 	uint16_t read10bitADC1( void );
 	uint16_t read10bitADC2( void );
@@ -151,13 +216,41 @@ public:
 	uint8_t fifoGetStatus( void );
 	void fifoStartRec();
 	void fifoEnd( void );
+
+	//Drains up to max stored samples into dst (dst[i][0..2] = X, Y, Z).
+	//  FIFO_SRC_REG is read once, then samples are pulled in as few
+	//  auto-increment bursts as the bus allows.  Returns samples read.
+	size_t fifoRead( int16_t (*dst)[3], size_t max );
+
+	//Watermark interrupt mode.  Configure settings.fifoThreshold and a
+	//  stream mode, call fifoBegin()/fifoStartRec(), then fifoWatermarkBegin().
+	//  The INT1 ISR only sets a flag (and notifies a task on ESP32); call
+	//  fifoService() from loop() or that task to drain into the ring.
+	status_t fifoWatermarkBegin( uint8_t int1Pin, LIS3DHSampleRing* ring );
+	void fifoWatermarkEnd( void );
+	bool fifoWatermarkPending( void ) const;
+	size_t fifoService( void );
+#if defined(ARDUINO_ARCH_ESP32)
+	//Task to receive a notification (ulTaskNotifyTake) on each watermark
+	void fifoWatermarkNotify( TaskHandle_t task );
+#endif
 	
 	float calcAccel( int16_t );
 	
 private:
+	static void handleWatermarkInterrupt( void* arg );
 
+	volatile bool watermarkPending;
+	uint8_t watermarkPin;
+	LIS3DHSampleRing* watermarkRing;
+#if defined(ARDUINO_ARCH_ESP32)
+	TaskHandle_t watermarkTask;
+#endif
 };
 
+//Depth of the on-chip FIFO (samples of X, Y, Z)
+#define LIS3DH_FIFO_DEPTH             32
+
 //Device Registers
 #define LIS3DH_STATUS_REG_AUX         0x07
 #define LIS3DH_OUT_ADC1_L             0x08
@@ -24,6 +24,7 @@
 
 // __________________________________________________________ PROJECT INCLUDES
 #include "i2c_adc_ads7828.h"
+#include "../i2c_utils.hpp"
 
 
 // ___________________________________________________ PUBLIC MEMBER FUNCTIONS
@@ -37,10 +38,49 @@ ADS7828Channel::ADS7828Channel(ADS7828* const device, uint8_t id,
     (bitRead(id, 2) << 5) | (bitRead(id, 1) << 4);
   this->minScale = min;
   this->maxScale = max;
+  this->filterType_ = FILTER_MOVING_AVERAGE;
+  this->filterBits_ = MOVING_AVERAGE_BITS_;
+  this->history_ = samples_;
   reset();
 }
 
 
+/// \overload ADS7828Channel::ADS7828Channel(const ADS7828Channel& other)
+ADS7828Channel::ADS7828Channel(const ADS7828Channel& other)
+{
+  *this = other;
+}
+
+
+/// Copy channel settings and filter state.
+/// \remark A channel using its built-in moving average array is rebound to
+///   the copy's own array; caller storage is shared.
+ADS7828Channel& ADS7828Channel::operator=(const ADS7828Channel& other)
+{
+  this->maxScale = other.maxScale;
+  this->minScale = other.minScale;
+  this->commandByte_ = other.commandByte_;
+  this->device_ = other.device_;
+  this->index_ = other.index_;
+  this->filterType_ = other.filterType_;
+  this->filterBits_ = other.filterBits_;
+  for (uint8_t k = 0; k < (1 << MOVING_AVERAGE_BITS_); k++)
+  {
+    this->samples_[k] = other.samples_[k];
+  }
+  this->total_ = other.total_;
+  if (FILTER_EXPONENTIAL == filterType_)
+  {
+    this->ema_ = other.ema_;
+  }
+  else
+  {
+    this->history_ = (other.history_ == other.samples_) ? samples_ : other.history_;
+  }
+  return *this;
+}
+
+
 /// Return command byte for channel object.
 /// \optional This function is for testing and troubleshooting.
 /// \return command byte (0x00..0xFC)
@@ -74,6 +114,60 @@ ADS7828* ADS7828Channel::device()
 }
 
 
+/// Select the filter applied to new samples and reset the channel.
+/// \param type \ref FILTER_MOVING_AVERAGE or \ref FILTER_EXPONENTIAL
+/// \param bits moving average of 2<sup>bits</sup> samples (0 = raw,
+///   limited to \ref ADS7828_MOVING_AVERAGE_BITS for the built-in storage
+///   and to \ref MAX_MOVING_AVERAGE_BITS for caller storage), or
+///   exponential weight 1/2<sup>bits</sup> (0 = raw, limited to
+///   \ref MAX_EXPONENTIAL_BITS)
+/// \param samples caller-owned array of at least 2<sup>bits</sup> samples
+///   for the moving average, or 0 (default) to use the built-in storage;
+///   must outlive the filter selection.  Ignored by \ref FILTER_EXPONENTIAL.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);                      // built with ADS7828_MOVING_AVERAGE_BITS=0
+/// static uint16_t history[8];
+/// adc.channel(0)->filter(FILTER_MOVING_AVERAGE, 3, history); // 8 sample average
+/// adc.channel(1)->filter(FILTER_EXPONENTIAL, 4); // slow, heavily smoothed
+/// ...
+/// \endcode
+void ADS7828Channel::filter(uint8_t type, uint8_t bits, uint16_t* samples)
+{
+  if (FILTER_EXPONENTIAL == type)
+  {
+    this->filterType_ = FILTER_EXPONENTIAL;
+    this->filterBits_ = (bits > MAX_EXPONENTIAL_BITS) ? MAX_EXPONENTIAL_BITS : bits;
+  }
+  else
+  {
+    const uint8_t limit = (0 != samples) ? MAX_MOVING_AVERAGE_BITS : MOVING_AVERAGE_BITS_;
+    this->filterType_ = FILTER_MOVING_AVERAGE;
+    this->filterBits_ = (bits > limit) ? limit : bits;
+    this->history_ = (0 != samples) ? samples : samples_;
+  }
+  reset();
+}
+
+
+/// Return filter depth (bits) for channel object.
+/// \return depth as set by filter()
+uint8_t ADS7828Channel::filterBits()
+{
+  return filterBits_;
+}
+
+
+/// Return filter type for channel object.
+/// \retval FILTER_MOVING_AVERAGE moving average (default)
+/// \retval FILTER_EXPONENTIAL exponential moving average
+uint8_t ADS7828Channel::filterType()
+{
+  return filterType_;
+}
+
+
 /// Return ID number of channel object (+IN connection).
 /// Single-ended inputs use COM as -IN; Differential inputs are as follows:
 /// \arg 0 indicates CH0 as +IN, CH1 as -IN
@@ -108,7 +202,7 @@ uint8_t ADS7828Channel::id()
 
 /// Return index position within moving average array.
 /// \optional This function is for testing and troubleshooting.
-/// \return index (0..2<sup>\ref MOVING_AVERAGE_BITS_</sup> - 1)
+/// \return index (0..2<sup>\ref filterBits()</sup> - 1)
 /// \par Usage:
 /// \code
 /// ...
@@ -123,21 +217,29 @@ uint8_t ADS7828Channel::index()
 }
 
 
-/// Add (unscaled) sample value to moving average array, update totalizer.
+/// Add (unscaled) sample value to filter, update totalizer.
 /// \param sample sample value (0x0000..0xFFFF)
 /// \remark Invoked by ADS7828::update() / ADS7828::updateAll() functions;
 ///   this function will not normally be called by end user.
 void ADS7828Channel::newSample(uint16_t sample)
 {
+  if (FILTER_EXPONENTIAL == filterType_)
+  {
+    // ema_ holds average << filterBits_
+    this->samples_[0] = sample;
+    this->ema_ = ema_ - (ema_ >> filterBits_) + sample;
+    return;
+  }
   this->index_++;
-  if (index_ >= (1 << MOVING_AVERAGE_BITS_)) this->index_ = 0;
-  this->total_ -= samples_[index_];
-  this->samples_[index_] = sample;
-  this->total_ += samples_[index_];
+  if (index_ >= (1 << filterBits_)) this->index_ = 0;
+  this->total_ -= history_[index_];
+  this->history_[index_] = sample;
+  this->total_ += history_[index_];
 }
 
 
-/// Reset moving average array, index, totalizer to zero.
+/// Reset moving average array, index, totalizer (or exponential accumulator)
+///   to zero.
 /// \par Usage:
 /// \code
 /// ...
@@ -153,6 +255,15 @@ void ADS7828Channel::reset()
   {
     this->samples_[k] = 0;
   }
+  if (FILTER_EXPONENTIAL == filterType_)
+  {
+    this->ema_ = 0;
+    return;
+  }
+  for (uint8_t k = 0; k < (1 << filterBits_); k++)
+  {
+    this->history_[k] = 0;
+  }
 }
 
 
@@ -169,7 +280,7 @@ void ADS7828Channel::reset()
 /// \endcode
 uint16_t ADS7828Channel::sample()
 {
-  return samples_[index_];
+  return (FILTER_EXPONENTIAL == filterType_) ? samples_[0] : history_[index_];
 }
 
 
@@ -197,7 +308,8 @@ uint8_t ADS7828Channel::start()
 
 /// Return (unscaled) totalizer value for channel object.
 /// \optional This function is for testing and troubleshooting.
-/// \return totalizer value (0x0000..0xFFFF)
+/// \return totalizer value (sum of samples); the unscaled average for
+///   \ref FILTER_EXPONENTIAL, whose accumulator does not fit 16 bits
 /// \par Usage:
 /// \code
 /// ...
@@ -208,7 +320,7 @@ uint8_t ADS7828Channel::start()
 /// \endcode
 uint16_t ADS7828Channel::total()
 {
-  return total_;
+  return (FILTER_EXPONENTIAL == filterType_) ? (uint16_t)(ema_ >> filterBits_) : total_;
 }
 
 
@@ -234,7 +346,7 @@ uint8_t ADS7828Channel::update()
 }
 
 
-/// Return moving average value for channel object.
+/// Return filtered (moving average or exponential) value for channel object.
 /// \required This is the most commonly-used channel function.
 /// \return scaled value (0x0000..0xFFFF)
 /// \par Usage:
@@ -247,7 +359,7 @@ uint8_t ADS7828Channel::update()
 /// \endcode
 uint16_t ADS7828Channel::value()
 {
-  uint16_t r = (total_ >> MOVING_AVERAGE_BITS_);
+  uint16_t r = (FILTER_EXPONENTIAL == filterType_) ? (ema_ >> filterBits_) : (total_ >> filterBits_);
   return map(r, DEFAULT_MIN_SCALE, DEFAULT_MAX_SCALE, minScale, maxScale);
 }
 
@@ -403,6 +515,25 @@ uint8_t ADS7828::commandByte()
 }
 
 
+/// Select the filter for all channels on device.
+/// \param type \ref FILTER_MOVING_AVERAGE or \ref FILTER_EXPONENTIAL
+/// \param bits filter depth; see ADS7828Channel::filter()
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// adc.filter(FILTER_MOVING_AVERAGE, 0); // raw samples on every channel
+/// ...
+/// \endcode
+void ADS7828::filter(uint8_t type, uint8_t bits)
+{
+  for (uint8_t ch = 0; ch < 8; ch++)
+  {
+    channels_[ch].filter(type, bits);
+  }
+}
+
+
 /// Initiate communication with device.
 /// \optional This function is for testing and troubleshooting and
 ///   can be used to determine whether a device is available (similar to
@@ -516,10 +647,42 @@ uint8_t ADS7828::update(uint8_t ch)
 /// \endcode
 void ADS7828::begin()
 {
+  bus_ = 0;
   Wire.begin();
 }
 
 
+/// Enable I2C communication through a shared bus manager.
+/// All devices then issue their transactions via \c bus, which serializes
+///   them against other tasks/drivers on the same controller (e.g. an
+///   LIS3DH read from another FreeRTOS task).  Use I2CBus::secondary() to
+///   place the ADCs on the second controller of an ESP32-S3.
+/// \param bus shared I2C bus manager
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   I2CBus::primary().begin();
+///   ADS7828::begin(I2CBus::primary());
+/// }
+/// ...
+/// \endcode
+void ADS7828::begin(I2CBus& bus)
+{
+  bus_ = &bus;
+  bus.begin();
+}
+
+
+/// Return the shared bus manager in use.
+/// \return pointer to I2CBus object, or 0 when using the global Wire
+I2CBus* ADS7828::bus()
+{
+  return bus_;
+}
+
+
 /// Return pointer to device object.
 /// \param address device address (0..3)
 /// \return pointer to ADS7828 object
@@ -600,6 +763,12 @@ uint16_t ADS7828::read()
 /// \return 16-bit zero-padded word (12 data bits D11..D0)
 uint16_t ADS7828::read(uint8_t address)
 {
+  if (0 != bus_)
+  {
+    uint8_t data[2] = {0, 0};
+    bus_->read(BASE_ADDRESS_ | (address & 0x03), data, 2);
+    return word(data[0], data[1]);
+  }
   Wire.requestFrom(BASE_ADDRESS_ | (address & 0x03), 2);
   return word(Wire.read(), Wire.read());
 }
@@ -615,6 +784,10 @@ uint16_t ADS7828::read(uint8_t address)
 /// \retval 4 other twi error (lost bus arbitration, bus error, ...)
 uint8_t ADS7828::start(uint8_t address, uint8_t command)
 {
+  if (0 != bus_)
+  {
+    return bus_->write(BASE_ADDRESS_ | (address & 0x03), &command, 1);
+  }
   Wire.beginTransmission(BASE_ADDRESS_ | (address & 0x03));
   Wire.write((uint8_t) command);
   return Wire.endTransmission();
@@ -657,4 +830,157 @@ uint8_t ADS7828::update(ADS7828* device, uint8_t ch)
 
 
 // _________________________________________________ STATIC PRIVATE ATTRIBTUES
-ADS7828* ADS7828::devices_[] = {};
\ No newline at end of file
+ADS7828* ADS7828::devices_[] = {};
+I2CBus* ADS7828::bus_ = 0;
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Non-blocking alternative to ADS7828::update() / ADS7828::updateAll().
+/// Each call to tick() performs exactly one I2C transaction: either the
+/// command byte that starts the next unmasked channel, or the read-back of
+/// the conversion started on the previous tick.  A sweep visits every
+/// unmasked channel of the selected device(s) once.
+/// \param device device to scan; 0 scans all registered devices
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc0(0);
+/// ADS7828 adc1(1);
+/// ADS7828Scanner scanner;  // all registered devices
+/// ...
+/// void loop()
+/// {
+///   ...
+///   if (scanner.tick())
+///   {
+///     // sweep complete; scanner.lastCount() channels updated
+///   }
+///   ...
+/// }
+/// ...
+/// \endcode
+ADS7828Scanner::ADS7828Scanner(ADS7828* const device)
+{
+  this->device_ = device;
+  reset();
+}
+
+
+/// Return quantity of channels updated so far in the current sweep.
+/// \return quantity of channels updated (0..32)
+uint8_t ADS7828Scanner::count()
+{
+  return count_;
+}
+
+
+/// Return quantity of channels updated in the most recently completed sweep.
+/// \return quantity of channels updated (0..32)
+/// \par Usage:
+/// \code
+/// ...
+/// if (scanner.tick() && scanner.lastCount() == 0)
+/// {
+///   // no device responded during the last sweep
+/// }
+/// ...
+/// \endcode
+uint8_t ADS7828Scanner::lastCount()
+{
+  return lastCount_;
+}
+
+
+/// Abandon the current sweep; the next tick() starts a new sweep.
+/// \note A conversion that was started but not yet read is discarded.
+void ADS7828Scanner::reset()
+{
+  this->position_ = END_;
+  this->count_ = this->lastCount_ = this->status_ = 0;
+  this->pending_ = false;
+}
+
+
+/// Return status of the most recent command byte transaction.
+/// \retval 0 success
+/// \retval 1 length too long for buffer
+/// \retval 2 address send, NACK received <b>(device not on bus)</b>
+/// \retval 3 data send, NACK received
+/// \retval 4 other twi error (lost bus arbitration, bus error, ...)
+uint8_t ADS7828Scanner::status()
+{
+  return status_;
+}
+
+
+/// Advance the scan by one I2C transaction.
+/// \required Call this from within \c loop() in place of update() /
+///   updateAll() when the caller must not block for a full sweep.
+/// \retval true a sweep completed on this tick
+/// \retval false sweep still in progress (or no unmasked channels)
+bool ADS7828Scanner::tick()
+{
+  ADS7828* device;
+
+  if (pending_)
+  {
+    // second half: read back the conversion started on the previous tick
+    device = resolve(position_);
+    this->pending_ = false;
+    if (0 != device)
+    {
+      device->channel(position_ & 0x07)->newSample(device->read());
+      this->count_++;
+    }
+  }
+  else
+  {
+    // first half: send the command byte for the next unmasked channel
+    if (END_ == position_) this->position_ = next(0);
+    if (END_ == position_) return false;
+    device = resolve(position_);
+    this->status_ = (0 != device) ? device->start(position_ & 0x07) : 2;
+    if (0 == status_)
+    {
+      this->pending_ = true;
+      return false;
+    }
+    // channel did not respond; skip it
+  }
+
+  this->position_ = next(position_ + 1);
+  if (END_ == position_)
+  {
+    this->lastCount_ = count_;
+    this->count_ = 0;
+    return true;
+  }
+  return false;
+}
+
+
+// __________________________________________________ PRIVATE MEMBER FUNCTIONS
+/// Return device for slot if slot refers to an unmasked channel.
+/// \param slot device address << 3 | channel
+/// \return pointer to device object, or 0
+ADS7828* ADS7828Scanner::resolve(uint8_t slot)
+{
+  ADS7828* device = (0 != device_) ? device_ : ADS7828::devices_[(slot >> 3) & 0x03];
+  if (0 == device) return 0;
+  if (!bitRead(device->channelMask, slot & 0x07)) return 0;
+  return device;
+}
+
+
+/// Return first slot at or after \c from that refers to an unmasked channel.
+/// \param from slot to start search from
+/// \return slot, or \ref END_ if none remain in this sweep
+uint8_t ADS7828Scanner::next(uint8_t from)
+{
+  uint8_t last = (0 != device_) ? 8 : 32;
+  for (uint8_t slot = from; slot < last; slot++)
+  {
+    if (0 != resolve(slot)) return slot;
+  }
+  return END_;
+}
\ No newline at end of file
@@ -82,8 +82,21 @@
 // include twi/i2c library
 #include <Wire.h>
 
+// shared bus manager (i2c_utils.hpp)
+class I2CBus;
+
 
 // ____________________________________________________________ UTILITY MACROS
+/// Size of each channel's built-in moving average storage, as a power of
+///   two (2<sup>ADS7828_MOVING_AVERAGE_BITS</sup> samples, at most
+///   \ref MAX_MOVING_AVERAGE_BITS).  This is also the default moving average
+///   depth.  Define as 0 in build flags to keep only the latest sample per
+///   channel, then pass caller-owned storage to ADS7828Channel::filter() for
+///   just the channels that average; raw and \ref FILTER_EXPONENTIAL channels
+///   need no sample history.
+#ifndef ADS7828_MOVING_AVERAGE_BITS
+#define ADS7828_MOVING_AVERAGE_BITS 4
+#endif
 
 
 // _________________________________________________________________ CONSTANTS
@@ -186,6 +199,46 @@ static const uint16_t DEFAULT_MIN_SCALE    = 0;
 static const uint16_t DEFAULT_MAX_SCALE    = 0xFFF;
 
 
+/// Channel filter: moving average over the last 2<sup>bits</sup> samples
+///   (default).  Depth 0 passes raw samples through.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// adc.channel(0)->filter(FILTER_MOVING_AVERAGE, 2); // 4 sample average
+/// adc.channel(1)->filter(FILTER_MOVING_AVERAGE, 0); // raw
+/// ...
+/// \endcode
+/// \relates ADS7828Channel
+static const uint8_t FILTER_MOVING_AVERAGE = 0;
+
+
+/// Channel filter: exponential moving average with weight 1/2<sup>bits</sup>,
+///   computed with an integer shift in constant memory.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// adc.channel(0)->filter(FILTER_EXPONENTIAL, 3); // alpha = 1/8
+/// ...
+/// \endcode
+/// \relates ADS7828Channel
+static const uint8_t FILTER_EXPONENTIAL    = 1;
+
+
+/// Largest shift accepted for \ref FILTER_EXPONENTIAL.
+/// \relates ADS7828Channel
+static const uint8_t MAX_EXPONENTIAL_BITS  = 8;
+
+
+/// Largest depth accepted for \ref FILTER_MOVING_AVERAGE (16 samples keep
+///   the 16-bit total of 12-bit samples from overflowing).
+/// \relates ADS7828Channel
+static const uint8_t MAX_MOVING_AVERAGE_BITS = 4;
+static_assert(ADS7828_MOVING_AVERAGE_BITS <= MAX_MOVING_AVERAGE_BITS,
+              "ADS7828_MOVING_AVERAGE_BITS exceeds MAX_MOVING_AVERAGE_BITS: the 16-bit total would overflow");
+
+
 // _________________________________________________________ CLASS DEFINITIONS
 class ADS7828;
 class ADS7828Channel
@@ -194,8 +247,13 @@ class ADS7828Channel
     // ............................................... public member functions
     ADS7828Channel() {};
     ADS7828Channel(ADS7828* const, uint8_t, uint8_t, uint16_t, uint16_t);
+    ADS7828Channel(const ADS7828Channel&);
+    ADS7828Channel& operator=(const ADS7828Channel&);
     uint8_t commandByte();
     ADS7828* device();
+    void filter(uint8_t, uint8_t, uint16_t* = 0);
+    uint8_t filterBits();
+    uint8_t filterType();
     uint8_t id();
     uint8_t index();
     void newSample(uint16_t);
@@ -250,18 +308,35 @@ class ADS7828Channel
     /// Index position within moving average array. 
     uint8_t index_;
 
-    /// Array of (unscaled) sample values.
-    /// \note Bit shift must match \ref MOVING_AVERAGE_BITS_.
-    uint16_t samples_[1 << 4];
+    /// Filter applied by newSample() (\ref FILTER_MOVING_AVERAGE or
+    ///   \ref FILTER_EXPONENTIAL).
+    uint8_t filterType_;
+
+    /// Filter depth: moving average of 2<sup>bits</sup> samples, or
+    ///   exponential weight 1/2<sup>bits</sup>.
+    uint8_t filterBits_;
+
+    /// Built-in array of (unscaled) sample values; slot 0 holds the latest
+    ///   sample when \ref FILTER_EXPONENTIAL is selected.
+    uint16_t samples_[1 << ADS7828_MOVING_AVERAGE_BITS];
 
     /// (Unscaled) running total of moving average array elements.
     uint16_t total_;
 
+    union
+    {
+      /// Moving average array in use: \ref samples_ or caller storage.
+      uint16_t* history_;
+
+      /// Exponential accumulator (average << \ref filterBits_); shares
+      ///   space with \ref history_, which the exponential filter does not use.
+      uint32_t ema_;
+    };
+
     // ............................................. static private attributes
-    /// Quantity of samples to be averaged =
+    /// Quantity of samples the built-in array holds =
     ///   2<sup>\ref MOVING_AVERAGE_BITS_</sup>.
-    /// \note \ref MOVING_AVERAGE_BITS_ must match \ref samples_ bit shift.
-    static const uint8_t MOVING_AVERAGE_BITS_ = 4;
+    static const uint8_t MOVING_AVERAGE_BITS_ = ADS7828_MOVING_AVERAGE_BITS;
 };
 
 
@@ -276,6 +351,7 @@ class ADS7828
     uint8_t address();
     ADS7828Channel* channel(uint8_t);
     uint8_t commandByte();
+    void filter(uint8_t, uint8_t); // all channels
     uint8_t start();
     uint8_t start(uint8_t);
     uint8_t update(); // single device, all unmasked channel
@@ -283,6 +359,8 @@ class ADS7828
 
     // ........................................ static public member functions
     static void begin();
+    static void begin(I2CBus&);
+    static I2CBus* bus();
     static ADS7828* device(uint8_t);
     static uint8_t updateAll(); // all devices, all unmasked channels
 
@@ -318,8 +396,54 @@ class ADS7828
     /// Array of pointers to registered device objects.
     static ADS7828* devices_[4];
 
+    /// Shared bus used by all devices, or 0 to use the global Wire directly.
+    static I2CBus* bus_;
+
     /// Factory pre-set slave address.
     static const uint8_t BASE_ADDRESS_ = 0x48;
+
+    friend class ADS7828Scanner;
+};
+
+
+class ADS7828Scanner
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Scanner(ADS7828* const = 0);
+    uint8_t count();
+    uint8_t lastCount();
+    void reset();
+    uint8_t status();
+    bool tick();
+
+  private:
+    // .............................................. private member functions
+    ADS7828* resolve(uint8_t);
+    uint8_t next(uint8_t);
+
+    // .................................................... private attributes
+    /// Device to scan, or 0 to scan all registered devices.
+    ADS7828* device_;
+
+    /// Current slot (device address << 3 | channel), \ref END_ when idle.
+    uint8_t position_;
+
+    /// Channels updated so far in the current sweep.
+    uint8_t count_;
+
+    /// Channels updated in the most recently completed sweep.
+    uint8_t lastCount_;
+
+    /// Status of the most recent start() transaction.
+    uint8_t status_;
+
+    /// True once the command byte has been sent and the result is unread.
+    bool pending_;
+
+    // ............................................. static private attributes
+    /// Slot value used when no channel is selected.
+    static const uint8_t END_ = 0xFF;
 };
 #endif
 /// \example examples/one_device/one_device.ino
@@ -1,5 +1,6 @@
 
 #include "button.h"
+#include "button_manager.h"
 
 Button::Button(int pin, unsigned long debounce_delay_ms, bool use_interrupts, bool btn_pulls_to_ground, unsigned long long_press_time_ms, unsigned long double_press_time_ms) {
     this->pin = pin;
@@ -17,7 +18,17 @@ Button::Button(int pin, unsigned long debounce_delay_ms, bool use_interrupts, bo
     this->state_handled = true;
     this->last_press_time = 0;
     this->debounce_state = BUTTON_UP;
-
+    this->manager = nullptr;
+    this->histogram = nullptr;
+    this->last_edge_us = 0;
+    this->transition_start_us = 0;
+    this->edges_in_transition = 0;
+    this->press_start_us = 0;
+    this->release_us = 0;
+    this->last_press_duration_us = 0;
+    this->last_settle_us = 0;
+    this->last_bounce_count = 0;
+    this->has_released = false;
 
     if (btn_pulls_to_ground) {
         pinMode(pin, INPUT_PULLUP);
@@ -26,22 +37,48 @@ Button::Button(int pin, unsigned long debounce_delay_ms, bool use_interrupts, bo
     }
     
     if (use_interrupts) {
+        // One handler per pin: a single CHANGE interrupt dispatches on the pin level
         attachInterruptArg(digitalPinToInterrupt(pin), [](void* arg) {
-            static_cast<Button*>(arg)->handleOnDownInterrupt();
-        }, this, btn_pulls_to_ground ? FALLING : RISING);
-        attachInterruptArg(digitalPinToInterrupt(pin), [](void* arg) {
-            static_cast<Button*>(arg)->handleOnUpInterrupt();
-        }, this, btn_pulls_to_ground ? RISING : FALLING);
+            static_cast<Button*>(arg)->handleEdgeInterrupt();
+        }, this, CHANGE);
     }
 }
 
 Button::~Button() {
+    if (this->manager != nullptr) {
+        this->manager->remove(*this);
+    }
     if (this->use_interrupts) {
         detachInterrupt(digitalPinToInterrupt(this->pin));
     }
 }
 
+void Button::handleEdgeInterrupt() {
+    int reading = digitalRead(this->pin);
+    if (this->btn_pulls_to_ground) {
+        reading = !reading;
+    }
+
+    if (reading) {
+        this->handleOnDownInterrupt();
+    } else {
+        this->handleOnUpInterrupt();
+    }
+}
+
+void Button::noteEdge(uint32_t edge_us) {
+    if (this->edges_in_transition == 0) {
+        this->transition_start_us = edge_us;
+    }
+    if (this->edges_in_transition < UINT16_MAX) {
+        this->edges_in_transition++;
+    }
+    this->last_edge_us = edge_us;
+}
+
 void Button::handleOnDownInterrupt() {
+    this->noteEdge(micros());
+
     if (this->state_from_interrupt == BUTTON_DOWN) {
         return; // Already down, no need to handle again
     }
@@ -50,6 +87,8 @@ void Button::handleOnDownInterrupt() {
 }
 
 void Button::handleOnUpInterrupt() {
+    this->noteEdge(micros());
+
     if (this->state_from_interrupt == BUTTON_UP) {
         return; // Already up, no need to handle again
     }
@@ -66,9 +105,31 @@ void Button::tick() {
         if (this->btn_pulls_to_ground) {
             reading = !reading; // Invert the reading if the button pulls to ground
         }
+        if (reading != this->debounce_state) {
+            this->noteEdge(micros());
+        }
     }
-    
-    unsigned long current_time = millis();
+
+    this->update(reading, millis());
+}
+
+void Button::recordEdge(int reading, unsigned long edge_time, uint32_t edge_us) {
+    this->noteEdge(edge_us);
+    if (reading != this->debounce_state) {
+        this->debounce_state = reading;
+        this->last_debounce_time = edge_time;
+    }
+}
+
+bool Button::needsService() const {
+    if (this->debounce_state != this->state) {
+        return true; // Waiting for the new level to stabilise
+    }
+    // A release waits for classification; a held press only changes on the next edge
+    return !this->state_handled && this->state == BUTTON_UP;
+}
+
+void Button::update(int reading, unsigned long current_time) {
     if (reading != this->debounce_state) {
         this->debounce_state = reading;
         this->last_debounce_time = current_time;
@@ -81,6 +142,7 @@ void Button::tick() {
             this->time_entered_state = current_time;
             this->state = reading;
             this->state_handled = false;
+            this->finishTransition();
 
             if (this->state == BUTTON_DOWN) {
                 this->time_of_last_up = current_time - this->duration_in_previous_state;
@@ -93,6 +155,12 @@ void Button::tick() {
                     this->onUpCallback();
                 }
             }
+        } else if (this->edges_in_transition > 0) {
+            // Edges settled back to the current state: a glitch, not a transition
+            this->edges_in_transition = 0;
+            if (this->histogram) {
+                this->histogram->glitches++;
+            }
         }
     }
 
@@ -122,26 +190,120 @@ void Button::tick() {
     }
 }
 
-void Button::onPressed(std::function<void(long)> callback) {
+void Button::onPressed(Delegate<void(long)> callback) {
     this->onPressedCallback = callback;
 }
 
-void Button::onDoublePressed(std::function<void(long)> callback) {
+void Button::onPressed(void (*callback)(void*, long), void* context) {
+    this->onPressedCallback = Delegate<void(long)>(callback, context);
+}
+
+void Button::onDoublePressed(Delegate<void(long)> callback) {
     this->onDoublePressedCallback = callback;
 }
 
-void Button::onLongPressed(std::function<void(long)> callback) {
+void Button::onDoublePressed(void (*callback)(void*, long), void* context) {
+    this->onDoublePressedCallback = Delegate<void(long)>(callback, context);
+}
+
+void Button::onLongPressed(Delegate<void(long)> callback) {
     this->onLongPressedCallback = callback;
 }
 
-void Button::onDown(std::function<void()> callback) {
+void Button::onLongPressed(void (*callback)(void*, long), void* context) {
+    this->onLongPressedCallback = Delegate<void(long)>(callback, context);
+}
+
+void Button::onDown(Delegate<void()> callback) {
     this->onDownCallback = callback;
 }
 
-void Button::onUp(std::function<void()> callback) {
+void Button::onDown(void (*callback)(void*), void* context) {
+    this->onDownCallback = Delegate<void()>(callback, context);
+}
+
+void Button::onUp(Delegate<void()> callback) {
     this->onUpCallback = callback;
 }
 
+void Button::onUp(void (*callback)(void*), void* context) {
+    this->onUpCallback = Delegate<void()>(callback, context);
+}
+
+void Button::finishTransition() {
+    uint16_t edges = this->edges_in_transition;
+    uint32_t start_us = this->transition_start_us;
+    uint32_t end_us = this->last_edge_us;
+    this->edges_in_transition = 0;
+    if (edges == 0) {
+        return; // No edge seen (e.g. polled before any change), nothing to measure
+    }
+
+    this->last_bounce_count = edges - 1;
+    this->last_settle_us = end_us - start_us;
+
+    if (this->state == BUTTON_DOWN) {
+        this->press_start_us = start_us;
+        if (this->histogram && this->has_released) {
+            this->histogram->release_gap_ms[ButtonHistogram::bucketFor((start_us - this->release_us) / 1000UL)]++;
+        }
+    } else {
+        this->release_us = start_us;
+        this->has_released = true;
+        this->last_press_duration_us = start_us - this->press_start_us;
+        if (this->histogram) {
+            this->histogram->press_ms[ButtonHistogram::bucketFor(this->last_press_duration_us / 1000UL)]++;
+        }
+    }
+
+    if (this->histogram) {
+        this->histogram->bounces[ButtonHistogram::bucketFor(this->last_bounce_count)]++;
+        this->histogram->settle_us[ButtonHistogram::bucketFor(this->last_settle_us)]++;
+    }
+}
+
+uint32_t Button::getLastEdgeMicros() const {
+    return this->last_edge_us;
+}
+
+uint32_t Button::getLastPressMicros() const {
+    return this->last_press_duration_us;
+}
+
+uint16_t Button::getLastBounceCount() const {
+    return this->last_bounce_count;
+}
+
+uint32_t Button::getLastSettleMicros() const {
+    return this->last_settle_us;
+}
+
+void Button::enableHistogram(ButtonHistogram* histogram) {
+    this->histogram = histogram;
+}
+
+void ButtonHistogram::reset() {
+    for (uint8_t i = 0; i < kBuckets; i++) {
+        this->bounces[i] = 0;
+        this->settle_us[i] = 0;
+        this->press_ms[i] = 0;
+        this->release_gap_ms[i] = 0;
+    }
+    this->glitches = 0;
+}
+
+uint8_t ButtonHistogram::bucketFor(uint32_t value) {
+    if (value == 0) {
+        return 0;
+    }
+    uint8_t bucket = 32 - __builtin_clz(value);
+    return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+uint32_t ButtonHistogram::bucketLowerBound(uint8_t bucket) {
+    return bucket == 0 ? 0 : (1UL << (bucket - 1));
+}
+
 unsigned long Button::getTimeInLastState() const {
     return this->duration_in_previous_state;
 }
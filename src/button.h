@@ -2,11 +2,43 @@
 #define BUTTON_H
 
 #include <Arduino.h>
-#include <functional>
+#include "delegate.hpp"
 
 #define BUTTON_UP 0
 #define BUTTON_DOWN 1
 
+class ButtonManager;
+
+/**
+ * @brief Optional per-button histograms used to tune debounce and press timings
+ * @note Every array uses log2 buckets: bucket 0 counts the value 0, bucket k counts values in [2^(k-1), 2^k), the last bucket also counts everything above.
+ */
+struct ButtonHistogram {
+    static const uint8_t kBuckets = 16;
+
+    uint32_t bounces[kBuckets];         // extra edges per debounced transition
+    uint32_t settle_us[kBuckets];       // first to last edge of a transition, in microseconds
+    uint32_t press_ms[kBuckets];        // edge-to-edge press duration, in milliseconds
+    uint32_t release_gap_ms[kBuckets];  // release to next press, in milliseconds (double press tuning)
+    uint32_t glitches;                  // edge bursts that settled back to the previous state
+
+    ButtonHistogram() { this->reset(); }
+
+    /**
+     * @brief Clear all buckets
+     */
+    void reset();
+
+    /**
+     * @brief Returns the bucket index for a value
+     */
+    static uint8_t bucketFor(uint32_t value);
+
+    /**
+     * @brief Returns the smallest value counted by a bucket
+     */
+    static uint32_t bucketLowerBound(uint8_t bucket);
+};
 
 class Button {
     private:
@@ -26,14 +58,47 @@ class Button {
         unsigned long last_press_time;
         bool state_handled;
 
+        ButtonManager* manager;
+        ButtonHistogram* histogram;
+
+        // Raw edge timing, written from the ISR (or tick() when polling)
+        volatile uint32_t last_edge_us;
+        volatile uint32_t transition_start_us;
+        volatile uint16_t edges_in_transition;
+        uint32_t press_start_us;
+        uint32_t release_us;
+        uint32_t last_press_duration_us;
+        uint32_t last_settle_us;
+        uint16_t last_bounce_count;
+        bool has_released;
+
+        void noteEdge(uint32_t edge_us);
+        void finishTransition();
+
+        void handleEdgeInterrupt();
         void handleOnDownInterrupt();
         void handleOnUpInterrupt();
 
-        std::function<void(long)> onPressedCallback;
-        std::function<void(long)> onDoublePressedCallback;
-        std::function<void(long)> onLongPressedCallback;
-        std::function<void()> onDownCallback;
-        std::function<void()> onUpCallback;
+        /**
+         * @brief Run debounce and press classification for a reading taken at current_time
+         */
+        void update(int reading, unsigned long current_time);
+        /**
+         * @brief Record an edge observed at edge_time / edge_us (used by ButtonManager instead of sampling)
+         */
+        void recordEdge(int reading, unsigned long edge_time, uint32_t edge_us);
+        /**
+         * @brief Whether update() still has work to do (debounce pending or press not yet classified)
+         */
+        bool needsService() const;
+
+        friend class ButtonManager;
+
+        Delegate<void(long)> onPressedCallback;
+        Delegate<void(long)> onDoublePressedCallback;
+        Delegate<void(long)> onLongPressedCallback;
+        Delegate<void()> onDownCallback;
+        Delegate<void()> onUpCallback;
         
     public:
         /** 
@@ -63,30 +128,36 @@ class Button {
          * @brief Set the callback function to be called when the button is pressed
          * @param callback The callback function to be called when the button is pressed
          * @note The callback function will be called with the time in milliseconds that the button was held pressed down for
+         * @note Callbacks are stored inline and never allocate; captures are limited to two pointers (see delegate.hpp)
          */
-        void onPressed(std::function<void(long)> callback);         // long is the time in ms that the button was pressed down for
+        void onPressed(Delegate<void(long)> callback);         // long is the time in ms that the button was pressed down for
+        void onPressed(void (*callback)(void*, long), void* context);
         /**
          * @brief Set the callback function to be called when the button is double pressed
          * @param callback The callback function to be called when the button is double pressed
          * @note The callback function will be called with the time in milliseconds between the two presses
          */
-        void onDoublePressed(std::function<void(long)> callback);   // long is the time between the two presses in ms
+        void onDoublePressed(Delegate<void(long)> callback);   // long is the time between the two presses in ms
+        void onDoublePressed(void (*callback)(void*, long), void* context);
         /**
          * @brief Set the callback function to be called when the button is long pressed
          * @param callback The callback function to be called when the button is long pressed
          * @note The callback function will be called with the time in milliseconds that the button was held pressed down for
          */
-        void onLongPressed(std::function<void(long)> callback);     // long is the time in ms that the button was pressed down for  
+        void onLongPressed(Delegate<void(long)> callback);     // long is the time in ms that the button was pressed down for
+        void onLongPressed(void (*callback)(void*, long), void* context);
         /**
          * @brief Set the callback function to be called when the button is pressed down
          * @param callback The callback function to be called when the button is pressed down
          */
-        void onDown(std::function<void()> callback);
+        void onDown(Delegate<void()> callback);
+        void onDown(void (*callback)(void*), void* context);
         /**
          * @brief Set the callback function to be called when the button is released
          * @param callback The callback function to be called when the button is released
          */
-        void onUp(std::function<void()> callback);
+        void onUp(Delegate<void()> callback);
+        void onUp(void (*callback)(void*), void* context);
 
         /**
          * @brief Returns a boolean indicating whether the button is currently pressed down
@@ -109,6 +180,35 @@ class Button {
          * @return The time in milliseconds that the button has been in the current state for
          */
         unsigned long getTimeInCurrentState() const;
+
+        /**
+         * @brief Returns the micros() timestamp of the most recent raw edge (including bounces)
+         * @note In polling mode edges are only seen at tick() time, so resolution is the poll interval.
+         */
+        uint32_t getLastEdgeMicros() const;
+
+        /**
+         * @brief Returns the duration of the last completed press in microseconds, measured from the first edge of the press to the first edge of the release
+         * @note Unlike getTimeInLastState(), this does not include tick() jitter or the debounce delay.
+         */
+        uint32_t getLastPressMicros() const;
+
+        /**
+         * @brief Returns the number of extra (bounce) edges seen during the last debounced transition
+         */
+        uint16_t getLastBounceCount() const;
+
+        /**
+         * @brief Returns the time from the first to the last edge of the last debounced transition in microseconds
+         * @note Use the worst case of this value when choosing debounce_delay_ms.
+         */
+        uint32_t getLastSettleMicros() const;
+
+        /**
+         * @brief Start recording bounce / press statistics into the given histogram
+         * @param histogram Storage owned by the caller, or nullptr to stop recording
+         */
+        void enableHistogram(ButtonHistogram* histogram);
 };
 
-#endif // BUTTON_H
\ No newline at end of file
+#endif // BUTTON_H
\ No newline at end of file
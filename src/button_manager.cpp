@@ -0,0 +1,161 @@
+#include "button_manager.h"
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+static_assert((BUTTON_MANAGER_QUEUE_SIZE & (BUTTON_MANAGER_QUEUE_SIZE - 1)) == 0, "BUTTON_MANAGER_QUEUE_SIZE must be a power of two");
+
+ButtonManager::ButtonManager() : head(0), tail(0), resync_mask(0), dropped_edges(0) {
+    this->active_mask = 0;
+    this->count = 0;
+    for (uint8_t i = 0; i < kMaxButtons; i++) {
+        this->slots[i].owner = this;
+        this->slots[i].button = nullptr;
+        this->slots[i].index = i;
+    }
+}
+
+ButtonManager::~ButtonManager() {
+    for (uint8_t i = 0; i < kMaxButtons; i++) {
+        if (this->slots[i].button != nullptr) {
+            this->remove(*this->slots[i].button);
+        }
+    }
+}
+
+bool ButtonManager::add(Button& button) {
+    if (button.manager != nullptr) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < kMaxButtons; i++) {
+        if (this->slots[i].button != nullptr) {
+            continue;
+        }
+
+        if (button.use_interrupts) {
+            detachInterrupt(digitalPinToInterrupt(button.pin));
+            button.use_interrupts = false;
+        }
+        button.manager = this;
+        this->slots[i].button = &button;
+        this->count++;
+
+        // Seed the current level on the next tick, then follow edges
+        this->resync_mask.fetch_or(1UL << i);
+        attachInterruptArg(digitalPinToInterrupt(button.pin), handleEdgeInterrupt, &this->slots[i], CHANGE);
+        return true;
+    }
+    return false;
+}
+
+void ButtonManager::remove(Button& button) {
+    for (uint8_t i = 0; i < kMaxButtons; i++) {
+        if (this->slots[i].button != &button) {
+            continue;
+        }
+
+        detachInterrupt(digitalPinToInterrupt(button.pin));
+        this->slots[i].button = nullptr;
+        this->resync_mask.fetch_and(~(1UL << i));
+        this->active_mask &= ~(1UL << i);
+        this->count--;
+        button.manager = nullptr;
+        return;
+    }
+}
+
+int ButtonManager::readButton(const Button& button) const {
+    int reading = digitalRead(button.pin);
+    if (button.btn_pulls_to_ground) {
+        reading = !reading; // Invert the reading if the button pulls to ground
+    }
+    return reading ? BUTTON_DOWN : BUTTON_UP;
+}
+
+void IRAM_ATTR ButtonManager::handleEdgeInterrupt(void* arg) {
+    Slot* slot = static_cast<Slot*>(arg);
+    ButtonManager* self = slot->owner;
+    Button* button = slot->button;
+    if (button == nullptr) {
+        return;
+    }
+
+    uint16_t h = self->head.load(std::memory_order_relaxed);
+    uint16_t next = (h + 1) & (BUTTON_MANAGER_QUEUE_SIZE - 1);
+    if (next == self->tail.load(std::memory_order_acquire)) {
+        // Queue full - have tick() re-read this button instead
+        self->resync_mask.fetch_or(1UL << slot->index);
+        self->dropped_edges.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Edge& edge = self->queue[h];
+    edge.slot = slot->index;
+    edge.reading = (uint8_t)self->readButton(*button);
+    edge.time_us = micros();
+    self->head.store(next, std::memory_order_release);
+}
+
+void ButtonManager::tick() {
+    // Snapshot the queue before the clock so every drained edge is older than now
+    uint16_t t = this->tail.load(std::memory_order_relaxed);
+    uint16_t h = this->head.load(std::memory_order_acquire);
+    unsigned long now_ms = millis();
+    uint32_t now_us = micros();
+
+    while (t != h) {
+        const Edge& edge = this->queue[t];
+        Button* button = this->slots[edge.slot].button;
+        if (button != nullptr) {
+            // Move the edge onto the millis() timeline the button uses
+            unsigned long edge_ms = now_ms - (unsigned long)((now_us - edge.time_us) / 1000UL);
+            button->recordEdge(edge.reading, edge_ms, edge.time_us);
+            this->active_mask |= 1UL << edge.slot;
+        }
+        t = (t + 1) & (BUTTON_MANAGER_QUEUE_SIZE - 1);
+    }
+    this->tail.store(t, std::memory_order_release);
+
+    uint32_t resync = this->resync_mask.exchange(0);
+    while (resync != 0) {
+        uint8_t i = (uint8_t)__builtin_ctz(resync);
+        resync &= resync - 1;
+        Button* button = this->slots[i].button;
+        if (button != nullptr) {
+            int reading = this->readButton(*button);
+            if (reading != button->debounce_state) {
+                button->recordEdge(reading, now_ms, now_us);
+            }
+            this->active_mask |= 1UL << i;
+        }
+    }
+
+    uint32_t active = this->active_mask;
+    while (active != 0) {
+        uint8_t i = (uint8_t)__builtin_ctz(active);
+        active &= active - 1;
+        Button* button = this->slots[i].button;
+        if (button == nullptr) {
+            this->active_mask &= ~(1UL << i);
+            continue;
+        }
+        button->update(button->debounce_state, now_ms);
+        if (!button->needsService()) {
+            this->active_mask &= ~(1UL << i);
+        }
+    }
+}
+
+uint8_t ButtonManager::size() const {
+    return this->count;
+}
+
+bool ButtonManager::isIdle() const {
+    return this->active_mask == 0 && this->head.load() == this->tail.load() && this->resync_mask.load() == 0;
+}
+
+uint32_t ButtonManager::getDroppedEdges() const {
+    return this->dropped_edges.load();
+}
@@ -0,0 +1,94 @@
+#ifndef BUTTON_MANAGER_H
+#define BUTTON_MANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "button.h"
+
+// Edge queue capacity, must be a power of two
+#ifndef BUTTON_MANAGER_QUEUE_SIZE
+#define BUTTON_MANAGER_QUEUE_SIZE 64
+#endif
+
+
+/**
+ * @brief Event-driven driver for many buttons sharing one ISR and one edge queue
+ * @note The shared ISR timestamps each edge with micros() and pushes it into a lock-free ring. tick() drains the ring and only runs the debounce / press state machine for buttons with pending edges or running timers, so idle buttons cost nothing.
+ * @note Call add() for every button from the same core so their interrupts are serviced by one CPU (the ring has a single producer).
+ */
+class ButtonManager {
+    public:
+        static const uint8_t kMaxButtons = 32;
+
+        ButtonManager();
+
+        /**
+         * @brief Destructor - detaches the interrupts of all registered buttons
+         */
+        ~ButtonManager();
+
+        ButtonManager(const ButtonManager&) = delete;
+        ButtonManager& operator=(const ButtonManager&) = delete;
+
+        /**
+         * @brief Register a button, replacing its own interrupts with the shared edge ISR
+         * @param button The button to manage (must outlive its registration; its destructor unregisters it)
+         * @return true if registered, false if the manager is full or the button is already managed
+         * @note Do not call tick() on a managed button, the manager drives it.
+         */
+        bool add(Button& button);
+
+        /**
+         * @brief Unregister a button and detach its interrupt
+         * @param button The button to remove
+         */
+        void remove(Button& button);
+
+        /**
+         * @brief Drain queued edges and advance buttons that have pending work - call this regularly from loop()
+         */
+        void tick();
+
+        /**
+         * @brief Returns the number of registered buttons
+         */
+        uint8_t size() const;
+
+        /**
+         * @brief Returns true when no button has pending edges or timers
+         */
+        bool isIdle() const;
+
+        /**
+         * @brief Returns the number of edges dropped because the queue was full
+         * @note Affected buttons are re-read directly on the next tick(), so only edge timing is lost.
+         */
+        uint32_t getDroppedEdges() const;
+
+    private:
+        struct Edge {
+            uint8_t slot;
+            uint8_t reading;
+            uint32_t time_us;
+        };
+
+        struct Slot {
+            ButtonManager* owner;
+            Button* button;
+            uint8_t index;
+        };
+
+        static void handleEdgeInterrupt(void* arg);
+        int readButton(const Button& button) const;
+
+        Slot slots[kMaxButtons];
+        Edge queue[BUTTON_MANAGER_QUEUE_SIZE];
+        std::atomic<uint16_t> head;             // written only by the ISR
+        std::atomic<uint16_t> tail;             // written only by tick()
+        std::atomic<uint32_t> resync_mask;      // buttons whose edges were dropped or that were just added
+        std::atomic<uint32_t> dropped_edges;
+        uint32_t active_mask;                   // buttons with debounce or press timers running
+        uint8_t count;
+};
+
+#endif // BUTTON_MANAGER_H
@@ -1,8 +1,68 @@
 
 #include "dc_motor.h"
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_arduino_version.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+DCMotor* DCMotor::motors_[DCMotor::kMaxMotors] = {};
+
+#if defined(ARDUINO_ARCH_ESP32)
+static esp_timer_handle_t ramp_timer = nullptr;
+// tickAll() runs on the esp_timer task (often the other core) while setSpeed()/stop()/brake() run
+// from loop(), and a ramp step must not land after a stop. Every command holds motor_io across its
+// decision and its pin writes; motor_mux only covers the ramp fields and the motors_ registry, so
+// no pin or LEDC call ever runs with interrupts disabled.
+static SemaphoreHandle_t motor_io = nullptr;
+static portMUX_TYPE motor_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+void DCMotor::ioLock() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (motor_io == nullptr) {
+        SemaphoreHandle_t created = xSemaphoreCreateMutex();
+        portENTER_CRITICAL(&motor_mux);
+        if (motor_io == nullptr) {
+            motor_io = created;
+            created = nullptr;
+        }
+        portEXIT_CRITICAL(&motor_mux);
+        if (created != nullptr) {
+            vSemaphoreDelete(created);  // another task won the race
+        }
+    }
+    if (motor_io != nullptr) {
+        xSemaphoreTake(motor_io, portMAX_DELAY);
+    }
+    #endif
+}
+
+void DCMotor::ioUnlock() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (motor_io != nullptr) {
+        xSemaphoreGive(motor_io);
+    }
+    #endif
+}
+
+void DCMotor::stateLock() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL(&motor_mux);
+    #endif
+}
+
+void DCMotor::stateUnlock() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL(&motor_mux);
+    #endif
+}
+
 DCMotor::DCMotor(uint8_t en_pin, uint8_t in1_pin, uint8_t in2_pin)
-        : en_pin_(en_pin), in1_pin_(in1_pin), in2_pin_(in2_pin), speed_(0), last_pwm_(0), last_dir_(0) {
+        : en_pin_(en_pin), in1_pin_(in1_pin), in2_pin_(in2_pin), speed_(0), max_speed_(kMaxSpeed), last_pwm_(0), last_dir_(0),
+          use_ledc_(false), ledc_channel_(0), target_speed_(0), ramp_rate_(0), last_ramp_us_(0), ramp_remainder_(0) {
     pinMode(en_pin_, OUTPUT);
     pinMode(in1_pin_, OUTPUT);
     pinMode(in2_pin_, OUTPUT);
@@ -10,6 +70,86 @@ DCMotor::DCMotor(uint8_t en_pin, uint8_t in1_pin, uint8_t in2_pin)
     digitalWrite(in1_pin_, LOW);
     digitalWrite(in2_pin_, LOW);
     analogWrite(en_pin_, 0);
+
+    // Register for tickAll(); motors beyond kMaxMotors can still be ticked individually.
+    // Only the spinlock here: global motors are constructed before the scheduler starts.
+    stateLock();
+    for (uint8_t i = 0; i < kMaxMotors; ++i) {
+        if (motors_[i] == nullptr) {
+            motors_[i] = this;
+            break;
+        }
+    }
+    stateUnlock();
+}
+
+DCMotor::~DCMotor() {
+    ioLock();  // waits for a tickAll() walk that may be stepping this motor
+    stateLock();
+    for (uint8_t i = 0; i < kMaxMotors; ++i) {
+        if (motors_[i] == this) {
+            motors_[i] = nullptr;
+        }
+    }
+    stateUnlock();
+    ioUnlock();
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+bool DCMotor::attachLEDC(uint8_t channel, uint32_t frequency, uint8_t resolution_bits) {
+    if (frequency == 0 || resolution_bits == 0 || resolution_bits > kMaxLedcResolutionBits) {
+        return false;
+    }
+    ioLock();
+    // Coast before switching so no stale duty is carried across resolutions; this also cancels a ramp.
+    stateLock();
+    ramp_rate_ = 0;
+    target_speed_ = 0;
+    stateUnlock();
+    applyPinsForSpeed(0, true);
+
+    #if ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcDetach(en_pin_);  // release the channel analogWrite (or a previous attachLEDC) attached
+    if (!ledcAttachChannel(en_pin_, frequency, resolution_bits, channel)) {
+        // The pin is detached now; fall back to analogWrite so later writes still reach it.
+        use_ledc_ = false;
+        max_speed_ = kMaxSpeed;
+        last_pwm_ = 0;
+        analogWrite(en_pin_, 0);
+        ioUnlock();
+        return false;
+    }
+    #else
+    // ledcSetup() fails before the pin is touched, so the previous backend stays attached.
+    if (ledcSetup(channel, frequency, resolution_bits) == 0) {
+        ioUnlock();
+        return false;
+    }
+    ledcAttachPin(en_pin_, channel);
+    #endif
+
+    use_ledc_ = true;
+    ledc_channel_ = channel;
+    max_speed_ = static_cast<int16_t>((1 << resolution_bits) - 1);
+    last_pwm_ = 0;
+    writePwm(0);
+    ioUnlock();
+    return true;
+}
+#endif
+
+void DCMotor::writePwm(uint16_t duty) {
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (use_ledc_) {
+        #if ESP_ARDUINO_VERSION_MAJOR >= 3
+        ledcWrite(en_pin_, duty);
+        #else
+        ledcWrite(ledc_channel_, duty);
+        #endif
+        return;
+    }
+    #endif
+    analogWrite(en_pin_, duty);
 }
 
 void DCMotor::applyPinsForSpeed(int16_t new_speed, bool forcePins) {
@@ -31,33 +171,165 @@ void DCMotor::applyPinsForSpeed(int16_t new_speed, bool forcePins) {
         last_dir_ = dir;
     }
 
-    uint8_t pwm = static_cast<uint8_t>(new_speed < 0 ? -new_speed : new_speed);
+    uint16_t pwm = static_cast<uint16_t>(new_speed < 0 ? -new_speed : new_speed);
     if (pwm != last_pwm_) {
-        analogWrite(en_pin_, pwm);
+        writePwm(pwm);
         last_pwm_ = pwm;
     }
     speed_ = new_speed;
 }
 
 void DCMotor::setSpeed(int speed) {
-    int16_t constrained = static_cast<int16_t>(constrain(speed, -kMaxSpeed, kMaxSpeed));
+    ioLock();
+    int16_t constrained = static_cast<int16_t>(constrain(speed, -max_speed_, max_speed_));
+    stateLock();
+    ramp_rate_ = 0;
+    target_speed_ = constrained;
+    stateUnlock();
+    applySpeed(constrained);
+    ioUnlock();
+}
+
+void DCMotor::applySpeed(int16_t speed) {
     // Fast path: if identical, skip writes.
-    if (constrained == speed_)
+    if (speed == speed_)
         return;
-    applyPinsForSpeed(constrained, false);
+    applyPinsForSpeed(speed, false);
+}
+
+void DCMotor::setTargetSpeed(int speed, uint32_t rate_per_s) {
+    int16_t constrained = static_cast<int16_t>(constrain(speed, -max_speed_, max_speed_));
+    if (rate_per_s == 0) {
+        setSpeed(constrained);
+        return;
+    }
+    uint32_t now = micros();
+    ioLock();  // speed_ is only stable while no step is writing it
+    stateLock();
+    // Restart timing only when a ramp begins so retargeting mid-ramp keeps a steady slew.
+    if (ramp_rate_ == 0) {
+        last_ramp_us_ = now;
+        ramp_remainder_ = 0;
+    }
+    target_speed_ = constrained;
+    ramp_rate_ = (constrained == speed_) ? 0 : rate_per_s;
+    stateUnlock();
+    ioUnlock();
+}
+
+bool DCMotor::tick() {
+    return tick(micros());
+}
+
+bool DCMotor::tick(uint32_t now_us) {
+    ioLock();
+    bool ramping = stepRamp(now_us);
+    ioUnlock();
+    return ramping;
 }
 
+bool DCMotor::stepRamp(uint32_t now_us) {
+    stateLock();
+    uint32_t rate = ramp_rate_;
+    if (rate == 0) {
+        stateUnlock();
+        return false;
+    }
+    int16_t target = target_speed_;
+
+    uint32_t elapsed = now_us - last_ramp_us_;
+    last_ramp_us_ = now_us;
+
+    // Whole speed units earned since the last step; keep the fraction for next time.
+    uint64_t progress = static_cast<uint64_t>(rate) * elapsed + ramp_remainder_;
+    uint64_t step = progress / 1000000ULL;
+    ramp_remainder_ = static_cast<uint32_t>(progress % 1000000ULL);
+    if (step == 0) {
+        stateUnlock();
+        return true;
+    }
+
+    int32_t distance = static_cast<int32_t>(target) - speed_;
+    int32_t magnitude = distance < 0 ? -distance : distance;
+    int16_t next = target;
+    if (step < static_cast<uint64_t>(magnitude)) {
+        next = static_cast<int16_t>(speed_ + (distance < 0 ? -static_cast<int32_t>(step) : static_cast<int32_t>(step)));
+    }
+    bool done = (next == target);
+    if (done) {
+        ramp_rate_ = 0;
+    }
+    stateUnlock();
+
+    // Pin I/O outside the spinlock; the caller's ioLock() keeps a stop() from interleaving.
+    applySpeed(next);
+    return !done;
+}
+
+uint8_t DCMotor::tickAll() {
+    uint32_t now = micros();
+    uint8_t ramping = 0;
+    ioLock();  // also keeps a destructor from unregistering a motor mid-walk
+    for (uint8_t i = 0; i < kMaxMotors; ++i) {
+        DCMotor* motor = motors_[i];
+        if (motor && motor->stepRamp(now)) {
+            ++ramping;
+        }
+    }
+    ioUnlock();
+    return ramping;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+bool DCMotor::startRampTimer(uint32_t period_us) {
+    if (period_us == 0) {
+        return false;
+    }
+    if (ramp_timer == nullptr) {
+        esp_timer_create_args_t args = {};
+        args.callback = [](void*) { DCMotor::tickAll(); };
+        args.dispatch_method = ESP_TIMER_TASK;  // task context: tickAll() takes a mutex
+        args.name = "dc_motor_ramp";
+        if (esp_timer_create(&args, &ramp_timer) != ESP_OK) {
+            ramp_timer = nullptr;
+            return false;
+        }
+    } else {
+        esp_timer_stop(ramp_timer);
+    }
+    return esp_timer_start_periodic(ramp_timer, period_us) == ESP_OK;
+}
+
+void DCMotor::stopRampTimer() {
+    if (ramp_timer != nullptr) {
+        esp_timer_stop(ramp_timer);
+    }
+}
+#endif
+
 void DCMotor::stop() {
+    ioLock();
+    stateLock();
+    ramp_rate_ = 0;
+    target_speed_ = 0;
+    stateUnlock();
     // Force coast even if already stopped to guarantee pin state.
     applyPinsForSpeed(0, true);
+    ioUnlock();
 }
 
 void DCMotor::brake() {
+    ioLock();
+    stateLock();
+    ramp_rate_ = 0;
+    target_speed_ = 0;
+    stateUnlock();
     // Active brake: both direction pins HIGH (depending on driver this may short motor terminals).
     digitalWrite(in1_pin_, HIGH);
     digitalWrite(in2_pin_, HIGH);
-    analogWrite(en_pin_, 0);
+    writePwm(0);
     speed_ = 0;
     last_pwm_ = 0;
     last_dir_ = 0; // treat as stopped direction-wise
+    ioUnlock();
 }
\ No newline at end of file
@@ -3,16 +3,21 @@
  * @brief Simple DC motor driver abstraction for an H-bridge (e.g. L298, TB6612)
  *
  * Features / design notes:
- * - Signed speed value in range [-255, 255]; sign encodes direction.
+ * - Signed speed value in range [-getMaxSpeed(), getMaxSpeed()] ([-255, 255] with analogWrite);
+ *   sign encodes direction.
  * - Internally skips redundant writes when setSpeed is called with unchanged value
  *   to reduce ISR latency / CPU usage on tight loops.
- * - Provides helper accessors for direction (+1,0,-1) and magnitude (0..255).
+ * - Provides helper accessors for direction (+1,0,-1) and magnitude (0..getMaxSpeed()).
  * - stop() performs a “coast” (both IN pins LOW). brake() performs an “active brake”
  *   (both IN pins HIGH) when supported by the H-bridge.
  * - All pin writes are performed only if necessary to avoid superfluous I/O.
  *
  * This class assumes an enable PWM pin plus two direction pins. The PWM write uses
  * analogWrite; on ESP32 the default Arduino core maps this to LEDC automatically.
+ * On ESP32, attachLEDC() binds the enable pin to a dedicated LEDC channel with a chosen
+ * frequency and resolution; the speed range then becomes [-(2^bits - 1), 2^bits - 1].
+ * - setTargetSpeed() ramps toward a target at a bounded slew rate, advanced by tick(),
+ *   by DCMotor::tickAll() for every motor at once, or by an optional esp_timer (ESP32).
  */
 
 #ifndef HUB_DC_MOTOR_H
@@ -22,7 +27,9 @@
 
 class DCMotor {
     public:
-        static constexpr int16_t kMaxSpeed = 255; // absolute maximum speed value
+        static constexpr int16_t kMaxSpeed = 255; // absolute maximum speed value (analogWrite backend)
+        static constexpr uint8_t kMaxLedcResolutionBits = 14; // keeps the speed range within int16_t
+        static constexpr uint8_t kMaxMotors = 8; // motors registered for tickAll()
 
         /**
          * @brief Construct a motor driver given enable + direction pins.
@@ -31,13 +38,74 @@ class DCMotor {
          * @param in2_pin Direction pin 2.
          */
         DCMotor(uint8_t en_pin, uint8_t in1_pin, uint8_t in2_pin);
+        ~DCMotor();
+
+        DCMotor(const DCMotor&) = delete;             // registered with tickAll() by address
+        DCMotor& operator=(const DCMotor&) = delete;
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Drive the enable pin from a dedicated LEDC channel instead of analogWrite.
+         * @param channel LEDC channel to use (analogWrite allocates from the highest channel down, so prefer low numbers).
+         * @param frequency PWM frequency in Hz (default 20kHz, above the audible range).
+         * @param resolution_bits Duty resolution, 1..14 bits (default 10). getMaxSpeed() becomes 2^bits - 1.
+         * @return true on success. On failure with Arduino-ESP32 3.x the pin falls back to analogWrite
+         *         (getMaxSpeed() is kMaxSpeed again); with 2.x the previous backend stays attached.
+         * @note The motor is put into coast; re-apply the speed afterwards.
+         */
+        bool attachLEDC(uint8_t channel, uint32_t frequency = 20000, uint8_t resolution_bits = 10);
+        #endif
 
         /**
          * @brief Set signed speed. Negative => reverse, positive => forward, 0 => stop (coast).
-         * @param speed Desired speed in range [-255, 255]; values are constrained.
+         * @param speed Desired speed in range [-getMaxSpeed(), getMaxSpeed()]; values are constrained.
          */
         void setSpeed(int speed);
 
+        /**
+         * @brief Ramp toward a signed target speed at a bounded slew rate. setSpeed(), stop() and brake() cancel the ramp.
+         * @param speed Target speed in range [-getMaxSpeed(), getMaxSpeed()]; values are constrained.
+         * @param rate_per_s Maximum change in speed units per second; 0 jumps straight to the target.
+         * @note The ramp only advances when tick() / tickAll() run (or the ramp timer is started).
+         */
+        void setTargetSpeed(int speed, uint32_t rate_per_s);
+
+        /**
+         * @brief Advance the ramp by the time elapsed since the previous step.
+         * @return true while the motor is still ramping.
+         */
+        bool tick();
+        bool tick(uint32_t now_us);
+
+        /**
+         * @brief Advance the ramps of all constructed motors (up to kMaxMotors) from a single call/timer.
+         * @return The number of motors still ramping.
+         */
+        static uint8_t tickAll();
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Run tickAll() periodically from an esp_timer (esp_timer task context, not an ISR).
+         * @param period_us Timer period in microseconds (default 5ms).
+         * @return true if the timer is running.
+         * @note Ramp steps, setSpeed(), stop() and brake() are serialized by one mutex held across each
+         *       decision and its pin writes, so a stop() from loop() on the other core is never overwritten
+         *       by an in-flight step. Motor commands must therefore come from task context, not an ISR.
+         */
+        static bool startRampTimer(uint32_t period_us = 5000);
+        static void stopRampTimer();
+        #endif
+
+        /**
+         * @brief Whether a setTargetSpeed() ramp is in progress.
+         */
+        bool isRamping() const { return ramp_rate_ != 0; }
+
+        /**
+         * @brief Speed the motor is ramping toward (equals getSpeed() when not ramping).
+         */
+        int16_t getTargetSpeed() const { return target_speed_; }
+
         /**
          * @brief Immediately stop (coast). Equivalent to setSpeed(0) but forces pin state update.
          */
@@ -49,14 +117,19 @@ class DCMotor {
         void brake();
 
         /**
-         * @brief Get last commanded signed speed (range [-255,255]).
+         * @brief Get last commanded signed speed (range [-getMaxSpeed(), getMaxSpeed()]).
          */
         int16_t getSpeed() const { return speed_; }
 
         /**
-         * @brief Get absolute speed magnitude (0..255).
+         * @brief Get absolute speed magnitude (0..getMaxSpeed()).
+         */
+        uint16_t getMagnitude() const { return static_cast<uint16_t>(speed_ < 0 ? -speed_ : speed_); }
+
+        /**
+         * @brief Largest accepted speed magnitude: kMaxSpeed, or 2^bits - 1 when bound to LEDC.
          */
-        uint8_t getMagnitude() const { return static_cast<uint8_t>(speed_ < 0 ? -speed_ : speed_); }
+        int16_t getMaxSpeed() const { return max_speed_; }
 
         /**
          * @brief Direction helper: -1 reverse, 0 stopped, +1 forward.
@@ -68,14 +141,35 @@ class DCMotor {
         }
 
     private:
+        friend class DCMotorGroup;
+
         uint8_t en_pin_;
         uint8_t in1_pin_;
         uint8_t in2_pin_;
-        int16_t speed_;       // signed speed [-255,255]
-        uint8_t last_pwm_;    // last PWM magnitude applied
+        int16_t speed_;       // signed speed [-max_speed_, max_speed_]
+        int16_t max_speed_;   // duty value for 100% (kMaxSpeed or LEDC 2^bits - 1)
+        uint16_t last_pwm_;   // last PWM magnitude applied
         int8_t last_dir_;     // cached direction (-1,0,1)
+        bool use_ledc_;       // enable pin driven through a dedicated LEDC channel
+        uint8_t ledc_channel_;
+        volatile int16_t target_speed_;   // ramp target
+        volatile uint32_t ramp_rate_;     // speed units per second; 0 => not ramping
+        uint32_t last_ramp_us_;           // time of previous ramp step
+        uint32_t ramp_remainder_;         // sub-unit progress carried between steps (units * us)
+
+        static DCMotor* motors_[kMaxMotors];
+
+        // Shared by every motor; no-ops off ESP32. ioLock() is a mutex held across a command's pin
+        // writes (task context only); stateLock() is a spinlock for the ramp fields and motors_.
+        static void ioLock();
+        static void ioUnlock();
+        static void stateLock();
+        static void stateUnlock();
 
+        bool stepRamp(uint32_t now_us);  // tick() body; caller holds ioLock()
         void applyPinsForSpeed(int16_t new_speed, bool forcePins);
+        void applySpeed(int16_t speed);
+        void writePwm(uint16_t duty);
 };
 
 #endif  // HUB_DC_MOTOR_H
\ No newline at end of file
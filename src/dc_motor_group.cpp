@@ -0,0 +1,136 @@
+#include "dc_motor_group.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/ledc.h>
+#include <soc/gpio_struct.h>
+#include <soc/soc_caps.h>
+#endif
+
+DCMotorGroup::DCMotorGroup() : motors_(), count_(0) {}
+
+DCMotorGroup::DCMotorGroup(std::initializer_list<DCMotor*> motors) : motors_(), count_(0) {
+    for (DCMotor* motor : motors) {
+        if (motor) {
+            add(*motor);
+        }
+    }
+}
+
+bool DCMotorGroup::add(DCMotor& motor) {
+    if (count_ >= kMaxMotors) {
+        return false;
+    }
+    motors_[count_++] = &motor;
+    return true;
+}
+
+void DCMotorGroup::setSpeeds(std::initializer_list<int16_t> speeds) {
+    setSpeeds(speeds.begin(), static_cast<uint8_t>(speeds.size()));
+}
+
+void DCMotorGroup::setSpeeds(const int16_t* speeds, uint8_t count) {
+    if (!speeds) {
+        return;
+    }
+    if (count > count_) {
+        count = count_;
+    }
+
+    int16_t next_speed[kMaxMotors];
+    int8_t next_dir[kMaxMotors];
+
+    // Same mutex as DCMotor: the ramp timer must not step a motor between the two phases.
+    DCMotor::ioLock();
+
+    // Phase 1: direction pins, batched into one set and one clear per bank.
+    #if defined(ARDUINO_ARCH_ESP32)
+    uint32_t set_lo = 0, clr_lo = 0;
+    #if SOC_GPIO_PIN_COUNT > 32
+    uint32_t set_hi = 0, clr_hi = 0;
+    #endif
+    #endif
+    for (uint8_t i = 0; i < count; ++i) {
+        DCMotor* m = motors_[i];
+        next_speed[i] = static_cast<int16_t>(constrain(speeds[i], -m->max_speed_, m->max_speed_));
+        next_dir[i] = next_speed[i] > 0 ? 1 : (next_speed[i] < 0 ? -1 : 0);
+        DCMotor::stateLock();
+        m->ramp_rate_ = 0;
+        m->target_speed_ = next_speed[i];
+        DCMotor::stateUnlock();
+        if (next_dir[i] == m->last_dir_) {
+            continue;
+        }
+
+        const bool in1_high = next_dir[i] > 0;
+        const bool in2_high = next_dir[i] < 0;
+        #if defined(ARDUINO_ARCH_ESP32)
+        const uint8_t pins[2] = { m->in1_pin_, m->in2_pin_ };
+        const bool high[2] = { in1_high, in2_high };
+        for (uint8_t p = 0; p < 2; ++p) {
+            #if SOC_GPIO_PIN_COUNT > 32
+            if (pins[p] >= 32) {
+                (high[p] ? set_hi : clr_hi) |= 1UL << (pins[p] - 32);
+                continue;
+            }
+            #endif
+            (high[p] ? set_lo : clr_lo) |= 1UL << pins[p];
+        }
+        #else
+        digitalWrite(m->in1_pin_, in1_high ? HIGH : LOW);
+        digitalWrite(m->in2_pin_, in2_high ? HIGH : LOW);
+        #endif
+    }
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (clr_lo) GPIO.out_w1tc = clr_lo;
+    if (set_lo) GPIO.out_w1ts = set_lo;
+    #if SOC_GPIO_PIN_COUNT > 32
+    if (clr_hi) GPIO.out1_w1tc.val = clr_hi;
+    if (set_hi) GPIO.out1_w1ts.val = set_hi;
+    #endif
+    #endif
+
+    // Phase 2: duties. LEDC channels are staged first, then latched together.
+    #if defined(ARDUINO_ARCH_ESP32)
+    bool staged[kMaxMotors] = {};
+    #endif
+    for (uint8_t i = 0; i < count; ++i) {
+        DCMotor* m = motors_[i];
+        m->last_dir_ = next_dir[i];
+        m->speed_ = next_speed[i];
+        uint16_t pwm = static_cast<uint16_t>(next_speed[i] < 0 ? -next_speed[i] : next_speed[i]);
+        if (pwm == m->last_pwm_) {
+            continue;
+        }
+        m->last_pwm_ = pwm;
+        #if defined(ARDUINO_ARCH_ESP32)
+        if (m->use_ledc_) {
+            // Match ledcWrite(): full scale maps to 2^bits so 100% is a constant high, as via setSpeed().
+            uint32_t duty = (pwm == static_cast<uint16_t>(m->max_speed_) && m->max_speed_ != 1) ? pwm + 1UL : pwm;
+            ledc_set_duty(static_cast<ledc_mode_t>(m->ledc_channel_ / 8), static_cast<ledc_channel_t>(m->ledc_channel_ % 8), duty);
+            staged[i] = true;
+            continue;
+        }
+        #endif
+        m->writePwm(pwm);
+    }
+    #if defined(ARDUINO_ARCH_ESP32)
+    for (uint8_t i = 0; i < count; ++i) {
+        if (staged[i]) {
+            ledc_update_duty(static_cast<ledc_mode_t>(motors_[i]->ledc_channel_ / 8), static_cast<ledc_channel_t>(motors_[i]->ledc_channel_ % 8));
+        }
+    }
+    #endif
+    DCMotor::ioUnlock();
+}
+
+void DCMotorGroup::stop() {
+    for (uint8_t i = 0; i < count_; ++i) {
+        motors_[i]->stop();
+    }
+}
+
+void DCMotorGroup::brake() {
+    for (uint8_t i = 0; i < count_; ++i) {
+        motors_[i]->brake();
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file dc_motor_group.h
+ * @brief Update several DCMotor instances (differential drive, 4WD) in one call.
+ *
+ * Features / design notes:
+ * - setSpeeds() takes every motor's speed at once and applies them in two phases:
+ *   all direction pins first, then all duties.
+ * - On ESP32 the direction pin changes are folded into one set mask and one clear mask
+ *   per GPIO bank, written through the W1TS/W1TC registers.
+ * - Motors bound with attachLEDC() have their duties staged with ledc_set_duty and then
+ *   latched back to back, so they take effect together at the next PWM period.
+ * - The same redundant-write skipping as DCMotor applies: unchanged directions and
+ *   duties cause no I/O. Any ramp in progress on a motor is cancelled.
+ * - The update holds DCMotor's shared mutex, so the ramp timer cannot step a
+ *   motor mid-update or overwrite a group stop().
+ */
+
+#ifndef HUB_DC_MOTOR_GROUP_H
+#define HUB_DC_MOTOR_GROUP_H
+
+#include <Arduino.h>
+#include <initializer_list>
+#include "dc_motor.h"
+
+class DCMotorGroup {
+    public:
+        static constexpr uint8_t kMaxMotors = DCMotor::kMaxMotors;
+
+        DCMotorGroup();
+
+        /**
+         * @brief Construct a group from motors, e.g. DCMotorGroup drive({&left, &right});
+         * @note Motors beyond kMaxMotors are ignored.
+         */
+        DCMotorGroup(std::initializer_list<DCMotor*> motors);
+
+        /**
+         * @brief Append a motor to the group.
+         * @return false if the group is full.
+         */
+        bool add(DCMotor& motor);
+
+        /**
+         * @brief Set all motor speeds in one update; speeds[i] applies to the i-th motor added.
+         * @param speeds Signed speeds, each constrained to that motor's [-getMaxSpeed(), getMaxSpeed()].
+         * @param count Number of speeds; motors beyond count are left unchanged.
+         */
+        void setSpeeds(const int16_t* speeds, uint8_t count);
+        void setSpeeds(std::initializer_list<int16_t> speeds);
+
+        /**
+         * @brief Coast every motor (forces pin state, as DCMotor::stop()).
+         */
+        void stop();
+
+        /**
+         * @brief Active brake on every motor (as DCMotor::brake()).
+         */
+        void brake();
+
+        uint8_t size() const { return count_; }
+        DCMotor* motor(uint8_t index) const { return index < count_ ? motors_[index] : nullptr; }
+
+    private:
+        DCMotor* motors_[kMaxMotors];
+        uint8_t count_;
+};
+
+#endif  // HUB_DC_MOTOR_GROUP_H
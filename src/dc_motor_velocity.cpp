@@ -0,0 +1,291 @@
+#include "dc_motor_velocity.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#if ESP_ARDUINO_VERSION_MAJOR < 3
+static bool pcnt_isr_service_ready = false;
+#endif
+
+DCMotorVelocityController::DCMotorVelocityController(DCMotor& motor, uint8_t enc_a_pin, uint8_t enc_b_pin, uint8_t pcnt_unit)
+        : motor_(motor), enc_a_pin_(enc_a_pin), enc_b_pin_(enc_b_pin), timer_(nullptr), period_us_(0), running_(false),
+          pcnt_ready_(false), last_position_(0), prev_velocity_(0), integral_(0), target_(0), velocity_(0), output_(0),
+          kp_(0), ki_(0), kd_(0), shift_(8) {
+    #if ESP_ARDUINO_VERSION_MAJOR >= 3
+    (void)pcnt_unit;
+    unit_ = nullptr;
+    channels_[0] = nullptr;
+    channels_[1] = nullptr;
+    #else
+    unit_ = static_cast<pcnt_unit_t>(pcnt_unit);
+    overflow_ = 0;
+    #endif
+}
+
+DCMotorVelocityController::~DCMotorVelocityController() {
+    end();
+    if (timer_ != nullptr) {
+        esp_timer_delete(timer_);
+        timer_ = nullptr;
+    }
+    releasePcnt();
+}
+
+bool DCMotorVelocityController::begin(uint32_t period_us, uint16_t filter_apb_cycles) {
+    if (period_us == 0) {
+        return false;
+    }
+    end();
+
+    if (!pcnt_ready_) {
+        if (!setupPcnt(filter_apb_cycles > 1023 ? 1023 : filter_apb_cycles)) {
+            return false;
+        }
+        pcnt_ready_ = true;
+    }
+
+    if (timer_ == nullptr) {
+        esp_timer_create_args_t args = {};
+        args.callback = timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;  // setSpeed() takes DCMotor's mutex
+        args.name = "dc_motor_pid";
+        if (esp_timer_create(&args, &timer_) != ESP_OK) {
+            timer_ = nullptr;
+            return false;
+        }
+    }
+
+    period_us_ = period_us;
+    last_position_ = getPosition();
+    reset();
+    running_ = esp_timer_start_periodic(timer_, period_us) == ESP_OK;
+    return running_;
+}
+
+void DCMotorVelocityController::end() {
+    if (!running_) {
+        return;
+    }
+    esp_timer_stop(timer_);
+    running_ = false;
+    output_ = 0;
+    velocity_ = 0;
+    motor_.stop();
+}
+
+void DCMotorVelocityController::setGains(int32_t kp, int32_t ki, int32_t kd, uint8_t shift) {
+    kp_ = kp;
+    ki_ = ki;
+    kd_ = kd;
+    shift_ = shift > 30 ? 30 : shift;
+    integral_ = 0;
+}
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+
+bool DCMotorVelocityController::setupPcnt(uint16_t filter_apb_cycles) {
+    pcnt_unit_config_t unit_cfg = {};
+    unit_cfg.low_limit = INT16_MIN;
+    unit_cfg.high_limit = INT16_MAX;
+    unit_cfg.flags.accum_count = 1;   // the driver carries the 16-bit count across the limits
+    if (pcnt_new_unit(&unit_cfg, &unit_) != ESP_OK) {
+        unit_ = nullptr;
+        return false;
+    }
+
+    // x4 quadrature: each channel counts edges of one signal, direction from the other.
+    const int edge_pins[2] = { enc_a_pin_, enc_b_pin_ };
+    const int level_pins[2] = { enc_b_pin_, enc_a_pin_ };
+    for (uint8_t i = 0; i < 2; ++i) {
+        pcnt_chan_config_t chan_cfg = {};
+        chan_cfg.edge_gpio_num = edge_pins[i];
+        chan_cfg.level_gpio_num = level_pins[i];
+        if (pcnt_new_channel(unit_, &chan_cfg, &channels_[i]) != ESP_OK) {
+            channels_[i] = nullptr;
+            releasePcnt();
+            return false;
+        }
+    }
+    pcnt_channel_set_edge_action(channels_[0], PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+    pcnt_channel_set_edge_action(channels_[1], PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+    for (uint8_t i = 0; i < 2; ++i) {
+        pcnt_channel_set_level_action(channels_[i], PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+    }
+
+    if (filter_apb_cycles > 0) {
+        pcnt_glitch_filter_config_t filter_cfg = {};
+        filter_cfg.max_glitch_ns = (static_cast<uint32_t>(filter_apb_cycles) * 25) / 2;   // 12.5ns APB cycles
+        pcnt_unit_set_glitch_filter(unit_, &filter_cfg);
+    }
+
+    // Watch points on the limits are what make accum_count extend the count.
+    if (pcnt_unit_add_watch_point(unit_, INT16_MAX) != ESP_OK || pcnt_unit_add_watch_point(unit_, INT16_MIN) != ESP_OK ||
+        pcnt_unit_enable(unit_) != ESP_OK) {
+        releasePcnt();
+        return false;
+    }
+    pcnt_unit_clear_count(unit_);
+    if (pcnt_unit_start(unit_) != ESP_OK) {
+        releasePcnt();
+        return false;
+    }
+    return true;
+}
+
+void DCMotorVelocityController::releasePcnt() {
+    if (unit_ == nullptr) {
+        return;
+    }
+    pcnt_unit_stop(unit_);
+    pcnt_unit_disable(unit_);     // errors ignored: the unit may not have been enabled yet
+    pcnt_unit_remove_watch_point(unit_, INT16_MAX);
+    pcnt_unit_remove_watch_point(unit_, INT16_MIN);
+    for (uint8_t i = 0; i < 2; ++i) {
+        if (channels_[i] != nullptr) {
+            pcnt_del_channel(channels_[i]);
+            channels_[i] = nullptr;
+        }
+    }
+    pcnt_del_unit(unit_);
+    unit_ = nullptr;
+    pcnt_ready_ = false;
+}
+
+int32_t DCMotorVelocityController::getPosition() const {
+    int count = 0;
+    pcnt_unit_get_count(unit_, &count);
+    return count;
+}
+
+#else
+
+bool DCMotorVelocityController::setupPcnt(uint16_t filter_apb_cycles) {
+    // x4 quadrature: each channel counts edges of one signal, direction from the other.
+    pcnt_config_t cfg = {};
+    cfg.unit = unit_;
+    cfg.counter_h_lim = INT16_MAX;
+    cfg.counter_l_lim = INT16_MIN;
+
+    cfg.channel = PCNT_CHANNEL_0;
+    cfg.pulse_gpio_num = enc_a_pin_;
+    cfg.ctrl_gpio_num = enc_b_pin_;
+    cfg.pos_mode = PCNT_COUNT_DEC;
+    cfg.neg_mode = PCNT_COUNT_INC;
+    cfg.lctrl_mode = PCNT_MODE_REVERSE;
+    cfg.hctrl_mode = PCNT_MODE_KEEP;
+    if (pcnt_unit_config(&cfg) != ESP_OK) {
+        return false;
+    }
+
+    cfg.channel = PCNT_CHANNEL_1;
+    cfg.pulse_gpio_num = enc_b_pin_;
+    cfg.ctrl_gpio_num = enc_a_pin_;
+    cfg.pos_mode = PCNT_COUNT_INC;
+    cfg.neg_mode = PCNT_COUNT_DEC;
+    if (pcnt_unit_config(&cfg) != ESP_OK) {
+        return false;
+    }
+
+    if (filter_apb_cycles > 0) {
+        pcnt_set_filter_value(unit_, filter_apb_cycles);
+        pcnt_filter_enable(unit_);
+    } else {
+        pcnt_filter_disable(unit_);
+    }
+
+    // Only the counter limits interrupt, to carry the 16-bit count into overflow_.
+    pcnt_event_enable(unit_, PCNT_EVT_H_LIM);
+    pcnt_event_enable(unit_, PCNT_EVT_L_LIM);
+    pcnt_counter_pause(unit_);
+    pcnt_counter_clear(unit_);
+    if (!pcnt_isr_service_ready) {
+        esp_err_t err = pcnt_isr_service_install(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // INVALID_STATE: already installed elsewhere
+            return false;
+        }
+        pcnt_isr_service_ready = true;
+    }
+    if (pcnt_isr_handler_add(unit_, overflowHandler, this) != ESP_OK) {
+        return false;
+    }
+    pcnt_counter_resume(unit_);
+    return true;
+}
+
+void DCMotorVelocityController::releasePcnt() {
+    if (pcnt_ready_) {
+        pcnt_counter_pause(unit_);
+        pcnt_isr_handler_remove(unit_);
+        pcnt_ready_ = false;
+    }
+}
+
+int32_t DCMotorVelocityController::getPosition() const {
+    // Retry if the limit ISR ran mid-read so overflow_ and the counter agree.
+    int32_t carried;
+    int16_t raw = 0;
+    do {
+        carried = overflow_;
+        pcnt_get_counter_value(unit_, &raw);
+    } while (carried != overflow_);
+    return carried + raw;
+}
+
+void IRAM_ATTR DCMotorVelocityController::overflowHandler(void* arg) {
+    DCMotorVelocityController* self = static_cast<DCMotorVelocityController*>(arg);
+    uint32_t status = 0;
+    pcnt_get_event_status(self->unit_, &status);
+    if (status & PCNT_EVT_H_LIM) {
+        self->overflow_ += INT16_MAX;
+    } else if (status & PCNT_EVT_L_LIM) {
+        self->overflow_ += INT16_MIN;
+    }
+}
+
+#endif  // ESP_ARDUINO_VERSION_MAJOR
+
+void DCMotorVelocityController::reset() {
+    integral_ = 0;
+    prev_velocity_ = velocity_;
+}
+
+void DCMotorVelocityController::timerCallback(void* arg) {
+    static_cast<DCMotorVelocityController*>(arg)->step();
+}
+
+void DCMotorVelocityController::step() {
+    int32_t position = getPosition();
+    int32_t delta = position - last_position_;
+    last_position_ = position;
+
+    int32_t velocity = static_cast<int32_t>(static_cast<int64_t>(delta) * 1000000LL / period_us_);
+    velocity_ = velocity;
+
+    const int32_t max_speed = motor_.getMaxSpeed();
+    const uint8_t shift = shift_;
+    const int32_t kp = kp_, ki = ki_, kd = kd_;
+    int32_t error = target_ - velocity;
+
+    // Anti-windup: the I term alone may not exceed full scale.
+    integral_ += error;
+    if (ki != 0) {
+        int64_t limit = (static_cast<int64_t>(max_speed) << shift) / (ki < 0 ? -ki : ki);
+        if (integral_ > limit) integral_ = static_cast<int32_t>(limit);
+        if (integral_ < -limit) integral_ = static_cast<int32_t>(-limit);
+    } else {
+        integral_ = 0;
+    }
+
+    int64_t u = static_cast<int64_t>(kp) * error
+              + static_cast<int64_t>(ki) * integral_
+              - static_cast<int64_t>(kd) * (velocity - prev_velocity_);
+    prev_velocity_ = velocity;
+
+    int64_t out = u >> shift;
+    if (out > max_speed) out = max_speed;
+    if (out < -max_speed) out = -max_speed;
+    output_ = static_cast<int16_t>(out);
+    motor_.setSpeed(output_);
+}
+
+#endif  // ARDUINO_ARCH_ESP32
@@ -0,0 +1,137 @@
+/**
+ * @file dc_motor_velocity.h
+ * @brief Encoder-backed closed-loop velocity control for a DCMotor (ESP32 only).
+ *
+ * Features / design notes:
+ * - Quadrature edges are counted in hardware by a PCNT unit (x4 decoding, glitch filter),
+ *   so there is no interrupt per encoder edge. The only interrupt fires when the 16-bit
+ *   counter reaches its limit, to extend it to 32 bits.
+ * - Arduino-ESP32 3.x (IDF 5) uses the pulse_cnt driver, whose accumulating count does the
+ *   32-bit extension itself; 2.x uses the legacy pcnt driver with a limit handler.
+ * - A fixed-rate integer PID runs from an esp_timer (hardware timer, esp_timer task context)
+ *   so control latency does not depend on how often loop() runs.
+ * - Velocities are in encoder counts per second; the output is the motor's signed speed
+ *   (duty) in [-getMaxSpeed(), getMaxSpeed()].
+ * - Gains are fixed point: output = (kp * e + ki * sum(e) - kd * dv) >> shift, with the
+ *   integral clamped so the I term alone cannot exceed full scale (anti-windup).
+ * - The derivative acts on the measured velocity, so target changes do not cause a kick.
+ *
+ * While the controller is running it owns the motor: do not call setSpeed() on it directly.
+ */
+
+#ifndef HUB_DC_MOTOR_VELOCITY_H
+#define HUB_DC_MOTOR_VELOCITY_H
+
+#include <Arduino.h>
+#include "dc_motor.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <esp_arduino_version.h>
+#include <esp_timer.h>
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <driver/pulse_cnt.h>
+#else
+#include <driver/pcnt.h>
+#endif
+
+class DCMotorVelocityController {
+    public:
+        /**
+         * @brief Bind a controller to a motor and its quadrature encoder.
+         * @param motor Motor to drive.
+         * @param enc_a_pin Encoder channel A.
+         * @param enc_b_pin Encoder channel B.
+         * @param pcnt_unit PCNT unit to use (0..3 on ESP32-S3); one per controller. Ignored on
+         *        Arduino-ESP32 3.x, where the driver allocates a free unit in begin().
+         */
+        DCMotorVelocityController(DCMotor& motor, uint8_t enc_a_pin, uint8_t enc_b_pin, uint8_t pcnt_unit = 0);
+        ~DCMotorVelocityController();
+
+        DCMotorVelocityController(const DCMotorVelocityController&) = delete;
+        DCMotorVelocityController& operator=(const DCMotorVelocityController&) = delete;
+
+        /**
+         * @brief Configure the PCNT unit and start the control timer.
+         * @param period_us Control period in microseconds (default 10ms / 100Hz).
+         * @param filter_apb_cycles Glitch filter length in APB cycles (12.5ns each, max 1023; 0 disables).
+         * @return true on success.
+         */
+        bool begin(uint32_t period_us = 10000, uint16_t filter_apb_cycles = 100);
+
+        /**
+         * @brief Stop the control timer and coast the motor. The encoder keeps counting.
+         */
+        void end();
+
+        /**
+         * @brief Set fixed point gains; each term is scaled by 2^-shift.
+         */
+        void setGains(int32_t kp, int32_t ki, int32_t kd, uint8_t shift = 8);
+
+        /**
+         * @brief Set the target velocity in encoder counts per second (signed).
+         */
+        void setTargetVelocity(int32_t counts_per_s) { target_ = counts_per_s; }
+        int32_t getTargetVelocity() const { return target_; }
+
+        /**
+         * @brief Velocity measured over the last control period, in counts per second.
+         */
+        int32_t getVelocity() const { return velocity_; }
+
+        /**
+         * @brief Accumulated encoder position in counts.
+         */
+        int32_t getPosition() const;
+
+        /**
+         * @brief Last speed (duty) applied to the motor.
+         */
+        int16_t getOutput() const { return output_; }
+
+        /**
+         * @brief Clear the integral and derivative state (e.g. after a stall).
+         */
+        void reset();
+
+        bool isRunning() const { return timer_ != nullptr && running_; }
+
+    private:
+        static void timerCallback(void* arg);
+        void step();
+        bool setupPcnt(uint16_t filter_apb_cycles);
+        void releasePcnt();
+
+        DCMotor& motor_;
+        uint8_t enc_a_pin_;
+        uint8_t enc_b_pin_;
+        #if ESP_ARDUINO_VERSION_MAJOR >= 3
+        pcnt_unit_handle_t unit_;
+        pcnt_channel_handle_t channels_[2];
+        #else
+        static void overflowHandler(void* arg);
+
+        pcnt_unit_t unit_;
+        volatile int32_t overflow_;   // counts carried out of the 16-bit hardware counter
+        #endif
+        esp_timer_handle_t timer_;
+        uint32_t period_us_;
+        bool running_;
+        bool pcnt_ready_;
+
+        int32_t last_position_;
+        int32_t prev_velocity_;
+        int32_t integral_;
+        volatile int32_t target_;
+        volatile int32_t velocity_;
+        volatile int16_t output_;
+        volatile int32_t kp_;
+        volatile int32_t ki_;
+        volatile int32_t kd_;
+        volatile uint8_t shift_;
+};
+
+#endif  // ARDUINO_ARCH_ESP32
+
+#endif  // HUB_DC_MOTOR_VELOCITY_H
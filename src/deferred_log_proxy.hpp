@@ -0,0 +1,456 @@
+#ifndef HUB_DEFERRED_LOG_PROXY_HPP
+#define HUB_DEFERRED_LOG_PROXY_HPP
+
+#include <string>
+#include <algorithm>
+#include <Arduino.h>
+#include <cstring>
+#include <cstdio>
+#include <new>
+#include <type_traits>
+#include "definitions.h"
+
+// DeferredLogProxy
+// ----------------
+// A CachingPrinter that stores binary log records and formats them only when they are read.
+//
+// Key characteristics:
+//  - log(fmt, args...) stores the format-string pointer, a millis() timestamp and the raw
+//    argument values (4 or 8 bytes each) - a handful of stores, no formatting on the hot path.
+//  - Ordinary Print output (print/println/write) is stored as text records; consecutive writes
+//    extend the same record, so per-character printing does not add per-record overhead.
+//  - Records are formatted when tail() runs or when service()/flush() drains them to Serial.
+//  - Fixed-size ring of whole records: the oldest records are evicted when space is needed.
+//  - Single writer; call log()/write() from one task (see SerialProxy concurrent mode otherwise).
+//
+// Format strings and %s arguments are read at format time, so they must stay valid for the
+// record's lifetime (string literals / flash-resident constants, not stack buffers).
+// Supported conversions: d i u x X o c s p f F e E g G a A and %%, with flags, width and
+// precision; length modifiers are accepted and ignored (argument sizes are recorded).
+
+class DeferredLogProxy : public CachingPrinter {
+    public:
+        static const uint8_t kMaxArgs = 8;
+        static const size_t kMaxFormattedLength = 192;  // Longest rendered log record (truncated beyond)
+
+    private:
+        enum : uint8_t { RECORD_TEXT = 1, RECORD_LOG = 2 };
+        enum : uint8_t { ARG_I32, ARG_U32, ARG_I64, ARG_U64, ARG_F64, ARG_PTR };
+        static const size_t kHeaderSize = 4;            // type, argc, uint16 record length
+        static const size_t kLogFixedSize = kHeaderSize + sizeof(const char*) + 4; // + fmt, timestamp (then 4-bit tags, args)
+        static const size_t kNone = static_cast<size_t>(-1);
+
+        template <typename T, typename D = typename std::decay<T>::type>
+        struct ArgTraits {
+            static_assert(std::is_arithmetic<D>::value || std::is_enum<D>::value || std::is_pointer<D>::value,
+                          "DeferredLogProxy::log() arguments must be numbers, enums or pointers");
+            static const uint8_t tag = std::is_pointer<D>::value ? ARG_PTR
+                                     : std::is_floating_point<D>::value ? ARG_F64
+                                     : sizeof(D) <= 4 ? (std::is_signed<D>::value ? ARG_I32 : ARG_U32)
+                                     : (std::is_signed<D>::value ? ARG_I64 : ARG_U64);
+            static const size_t size = tag == ARG_PTR ? sizeof(void*) : (tag == ARG_I32 || tag == ARG_U32) ? 4 : 8;
+        };
+
+        template <typename... Args> struct ArgPack;
+        template <typename First, typename... Rest>
+        struct ArgPack<First, Rest...> {
+            static const size_t size = ArgTraits<First>::size + ArgPack<Rest...>::size;
+            static const uint32_t tags = ArgTraits<First>::tag | (ArgPack<Rest...>::tags << 4);
+        };
+        template <typename... Args>
+        struct ArgPack {
+            static const size_t size = 0;
+            static const uint32_t tags = 0;
+        };
+
+        size_t buf_size_;          // Total capacity
+        byte* buf_;                // Record storage
+        size_t head_;              // Next write index
+        size_t tail_;              // Oldest record
+        size_t wrap_end_;          // End of the records before the wrap, when wrapped_
+        bool wrapped_;             // Records run [tail_, wrap_end_) then [0, head_)
+        size_t records_;           // Stored record count
+        size_t last_text_;         // TEXT record ending at head_ (extendable), or kNone
+        size_t cursor_;            // Next record to send to Serial
+        size_t cursor_offset_;     // Bytes of that record's rendering already sent
+        size_t pending_;           // Records not yet (fully) sent
+        uint32_t dropped_;         // Records evicted before they were sent
+        bool timestamps_;          // Prefix rendered log records with "[millis] "
+
+        inline size_t recordLength(size_t pos) const {
+            return buf_[pos + 2] | (static_cast<size_t>(buf_[pos + 3]) << 8);
+        }
+
+        inline void setRecordLength(size_t pos, size_t len) {
+            buf_[pos + 2] = static_cast<byte>(len & 0xFF);
+            buf_[pos + 3] = static_cast<byte>(len >> 8);
+        }
+
+        inline size_t nextRecord(size_t pos) const {
+            pos += recordLength(pos);
+            return (wrapped_ && pos == wrap_end_) ? 0 : pos;
+        }
+
+        void evictOldest() {
+            size_t next = nextRecord(tail_);
+            if (pending_ > 0 && cursor_ == tail_) {
+                dropped_++;
+                pending_--;
+                cursor_ = next;
+                cursor_offset_ = 0;
+            }
+            if (last_text_ == tail_) last_text_ = kNone;
+            if (wrapped_ && next == 0) wrapped_ = false;
+            tail_ = next;
+            if (--records_ == 0) {
+                head_ = tail_ = 0; wrapped_ = false; last_text_ = kNone;
+            }
+        }
+
+        // Contiguous free bytes at head_ without evicting
+        inline size_t freeAtHead() const {
+            if (records_ == 0) return buf_size_;
+            return wrapped_ ? tail_ - head_ : buf_size_ - head_;
+        }
+
+        // Make len contiguous bytes available at head_, evicting the oldest records as needed
+        size_t reserve(size_t len) {
+            if (!buf_ || len > buf_size_) return kNone;
+            for (;;) {
+                if (records_ == 0) { head_ = tail_ = 0; wrapped_ = false; }
+                if (!wrapped_) {
+                    if (buf_size_ - head_ >= len) return head_;
+                    wrap_end_ = head_; wrapped_ = true; head_ = 0; last_text_ = kNone;
+                } else {
+                    if (tail_ - head_ >= len) return head_;
+                    evictOldest();
+                }
+            }
+        }
+
+        void commit(size_t pos, uint8_t type, uint8_t argc, size_t len) {
+            buf_[pos] = type;
+            buf_[pos + 1] = argc;
+            setRecordLength(pos, len);
+            head_ = pos + len;
+            records_++;
+            last_text_ = (type == RECORD_TEXT) ? pos : kNone;
+            if (pending_++ == 0) { cursor_ = pos; cursor_offset_ = 0; }
+        }
+
+        void appendText(const uint8_t* data, size_t len) {
+            if (!buf_) return;
+            if (len > buf_size_ - kHeaderSize) { // Only the newest bytes can fit
+                data += len - (buf_size_ - kHeaderSize);
+                len = buf_size_ - kHeaderSize;
+            }
+            while (len > 0) {
+                if (last_text_ != kNone) {
+                    size_t rec_len = recordLength(last_text_);
+                    size_t n = std::min(std::min(len, freeAtHead()), static_cast<size_t>(0xFFFF) - rec_len);
+                    if (n > 0) {
+                        if (pending_ == 0) { pending_ = 1; cursor_ = last_text_; cursor_offset_ = rec_len - kHeaderSize; }
+                        memcpy(buf_ + head_, data, n);
+                        setRecordLength(last_text_, rec_len + n);
+                        head_ += n; data += n; len -= n;
+                        continue;
+                    }
+                }
+                size_t chunk = std::min(len, static_cast<size_t>(0xFFFF) - kHeaderSize);
+                size_t pos = reserve(kHeaderSize + chunk);
+                if (pos == kNone) return;
+                memcpy(buf_ + pos + kHeaderSize, data, chunk);
+                commit(pos, RECORD_TEXT, 0, kHeaderSize + chunk);
+                data += chunk; len -= chunk;
+            }
+        }
+
+        template <typename T>
+        static void encodeArg(byte*& out, T value, std::true_type /* pointer */) {
+            const void* ptr = value;
+            memcpy(out, &ptr, sizeof(ptr)); out += sizeof(ptr);
+        }
+
+        template <typename T>
+        static void encodeArg(byte*& out, T value, std::false_type /* number */) {
+            typedef typename std::decay<T>::type D;
+            switch (ArgTraits<D>::tag) {
+                case ARG_I32: { int32_t v = static_cast<int32_t>(value); memcpy(out, &v, 4); out += 4; break; }
+                case ARG_U32: { uint32_t v = static_cast<uint32_t>(value); memcpy(out, &v, 4); out += 4; break; }
+                case ARG_I64: { int64_t v = static_cast<int64_t>(value); memcpy(out, &v, 8); out += 8; break; }
+                case ARG_U64: { uint64_t v = static_cast<uint64_t>(value); memcpy(out, &v, 8); out += 8; break; }
+                default: { double v = static_cast<double>(value); memcpy(out, &v, 8); out += 8; break; }
+            }
+        }
+
+        static void encodeArgs(byte*&) {}
+
+        template <typename First, typename... Rest>
+        static void encodeArgs(byte*& out, First first, Rest... rest) {
+            encodeArg(out, first, std::integral_constant<bool, std::is_pointer<typename std::decay<First>::type>::value>());
+            encodeArgs(out, rest...);
+        }
+
+        struct ArgValue {
+            uint8_t tag;
+            int64_t i;
+            uint64_t u;
+            double d;
+            const void* p;
+        };
+
+        static ArgValue decodeArg(const byte*& in, uint8_t tag) {
+            ArgValue v; v.tag = tag; v.i = 0; v.u = 0; v.d = 0; v.p = nullptr;
+            switch (tag) {
+                case ARG_I32: { int32_t x; memcpy(&x, in, 4); in += 4; v.i = x; v.u = static_cast<uint64_t>(x); v.d = x; break; }
+                case ARG_U32: { uint32_t x; memcpy(&x, in, 4); in += 4; v.i = x; v.u = x; v.d = x; break; }
+                case ARG_I64: { int64_t x; memcpy(&x, in, 8); in += 8; v.i = x; v.u = static_cast<uint64_t>(x); v.d = static_cast<double>(x); break; }
+                case ARG_U64: { uint64_t x; memcpy(&x, in, 8); in += 8; v.i = static_cast<int64_t>(x); v.u = x; v.d = static_cast<double>(x); break; }
+                case ARG_F64: { double x; memcpy(&x, in, 8); in += 8; v.i = static_cast<int64_t>(x); v.u = static_cast<uint64_t>(v.i); v.d = x; break; }
+                default: { memcpy(&v.p, in, sizeof(v.p)); in += sizeof(v.p); v.i = static_cast<int64_t>(reinterpret_cast<intptr_t>(v.p)); v.u = static_cast<uint64_t>(v.i); break; }
+            }
+            return v;
+        }
+
+        static size_t appendFormatted(char* out, size_t n, size_t cap, const char* spec, const ArgValue& v, char conv) {
+            if (n >= cap) return n;
+            int written = 0;
+            switch (conv) {
+                case 'd': case 'i':
+                    written = snprintf(out + n, cap - n, spec, static_cast<long long>(v.i)); break;
+                case 'u': case 'x': case 'X': case 'o':
+                    written = snprintf(out + n, cap - n, spec, static_cast<unsigned long long>(v.u)); break;
+                case 'c':
+                    written = snprintf(out + n, cap - n, spec, static_cast<int>(v.i)); break;
+                case 's':
+                    written = snprintf(out + n, cap - n, spec, v.tag == ARG_PTR && v.p ? static_cast<const char*>(v.p) : "(null)"); break;
+                case 'p':
+                    written = snprintf(out + n, cap - n, spec, v.p); break;
+                default:
+                    written = snprintf(out + n, cap - n, spec, v.d); break;
+            }
+            if (written < 0) return n;
+            return std::min(cap - 1, n + static_cast<size_t>(written));
+        }
+
+        // Render a LOG record (printf subset) into out; always ends with a newline unless truncated
+        size_t renderLog(size_t pos, char* out, size_t cap) const {
+            const byte* in = buf_ + pos + kHeaderSize;
+            uint8_t argc = buf_[pos + 1];
+            const char* fmt; uint32_t timestamp; uint32_t tags;
+            memcpy(&fmt, in, sizeof(fmt)); in += sizeof(fmt);
+            memcpy(&timestamp, in, 4); in += 4;
+            tags = 0; memcpy(&tags, in, (argc + 1) / 2); in += (argc + 1) / 2;
+
+            size_t n = 0;
+            if (timestamps_) {
+                int w = snprintf(out, cap, "[%lu] ", static_cast<unsigned long>(timestamp));
+                n = w > 0 ? std::min(cap - 1, static_cast<size_t>(w)) : 0;
+            }
+            uint8_t arg = 0;
+            const char* f = fmt ? fmt : "";
+            while (*f && n < cap - 1) {
+                if (*f != '%') { out[n++] = *f++; continue; }
+                if (f[1] == '%') { out[n++] = '%'; f += 2; continue; }
+
+                char spec[24]; size_t sp = 0;
+                spec[sp++] = *f++;
+                while (*f && strchr("-+ #0", *f) && sp < 8) spec[sp++] = *f++;
+                while (*f >= '0' && *f <= '9' && sp < 14) spec[sp++] = *f++;
+                if (*f == '.') { spec[sp++] = *f++; while (*f >= '0' && *f <= '9' && sp < 18) spec[sp++] = *f++; }
+                while (*f && strchr("hlLzjtq", *f)) f++; // Sizes come from the recorded tags
+                char conv = *f;
+                if (!conv) break;
+                f++;
+                if (!strchr("diuxXocspfFeEgGaA", conv) || arg >= argc) continue;
+
+                if (strchr("diuxXo", conv)) { spec[sp++] = 'l'; spec[sp++] = 'l'; }
+                spec[sp++] = conv; spec[sp] = '\0';
+                ArgValue v = decodeArg(in, static_cast<uint8_t>((tags >> (4 * arg)) & 0x0F));
+                arg++;
+                n = appendFormatted(out, n, cap, spec, v, conv);
+            }
+            if (n == 0 || out[n - 1] != '\n') {
+                if (n >= cap - 1) n = cap - 2; // Truncated: keep room for the line terminator
+                out[n++] = '\n';
+            }
+            out[n] = '\0';
+            return n;
+        }
+
+        // Lines a record contributes to the tail() view
+        size_t recordNewlines(size_t pos) const {
+            if (buf_[pos] == RECORD_TEXT) {
+                size_t count = 0, len = recordLength(pos) - kHeaderSize;
+                const byte* p = buf_ + pos + kHeaderSize;
+                for (size_t i = 0; i < len; i++) if (p[i] == '\n') count++;
+                return count;
+            }
+            const char* fmt;
+            memcpy(&fmt, buf_ + pos + kHeaderSize, sizeof(fmt));
+            size_t count = 0, len = fmt ? strlen(fmt) : 0;
+            for (size_t i = 0; i < len; i++) if (fmt[i] == '\n') count++;
+            return (len > 0 && fmt[len - 1] == '\n') ? count : count + 1;
+        }
+
+        // Visit a record's rendering from offset as one span; returns the full rendered length
+        template <typename Visitor>
+        size_t visitRecord(size_t pos, size_t offset, Visitor visit) const {
+            if (buf_[pos] == RECORD_TEXT) {
+                size_t len = recordLength(pos) - kHeaderSize;
+                if (offset < len) visit(buf_ + pos + kHeaderSize + offset, len - offset);
+                return len;
+            }
+            char text[kMaxFormattedLength];
+            size_t len = renderLog(pos, text, sizeof(text));
+            if (offset < len) visit(reinterpret_cast<const uint8_t*>(text) + offset, len - offset);
+            return len;
+        }
+
+        // Stream the last `lines` lines to visit(data, len); returns bytes visited
+        template <typename Visitor>
+        size_t emitTail(size_t lines, Visitor visit) const {
+            if (!buf_ || lines == 0 || records_ == 0) return 0;
+            size_t newlines = 0;
+            size_t pos = tail_, last = tail_;
+            for (size_t r = 0; r < records_; r++, last = pos, pos = nextRecord(pos)) newlines += recordNewlines(pos);
+            bool terminated = buf_[last] == RECORD_LOG || buf_[last + recordLength(last) - 1] == '\n';
+            size_t total = newlines + (terminated ? 0 : 1);
+            size_t skip = total > lines ? total - lines : 0;
+
+            size_t emitted = 0;
+            pos = tail_;
+            for (size_t r = 0; r < records_; r++, pos = nextRecord(pos)) {
+                visitRecord(pos, 0, [&](const uint8_t* data, size_t len) {
+                    size_t i = 0;
+                    while (skip > 0 && i < len) { if (data[i++] == '\n') skip--; }
+                    if (skip == 0 && i < len) { visit(data + i, len - i); emitted += len - i; }
+                });
+            }
+            return emitted;
+        }
+
+        size_t drain(size_t max_bytes, bool blocking) {
+            if (!buf_ || !Serial) return 0;
+            size_t sent = 0;
+            while (pending_ > 0 && sent < max_bytes) {
+                size_t room = max_bytes - sent;
+                if (!blocking) {
+                    int avail = Serial.availableForWrite();
+                    room = std::min(room, avail > 0 ? static_cast<size_t>(avail) : 0);
+                    if (room == 0) break;
+                }
+                size_t chunk = 0;
+                size_t total = visitRecord(cursor_, cursor_offset_, [&](const uint8_t* data, size_t len) {
+                    chunk = std::min(len, room);
+                    Serial.write(data, chunk);
+                });
+                cursor_offset_ += chunk;
+                sent += chunk;
+                if (cursor_offset_ < total) break; // Serial is full (or budget reached) mid-record
+                cursor_offset_ = 0;
+                if (--pending_ > 0) cursor_ = nextRecord(cursor_);
+            }
+            return sent;
+        }
+
+    public:
+        explicit DeferredLogProxy(size_t buf_size = 2048)
+            : buf_size_(buf_size), buf_(nullptr), head_(0), tail_(0), wrap_end_(0), wrapped_(false), records_(0),
+              last_text_(kNone), cursor_(0), cursor_offset_(0), pending_(0), dropped_(0), timestamps_(true) {
+            if (buf_size_ < kLogFixedSize + 12 * kMaxArgs) buf_size_ = kLogFixedSize + 12 * kMaxArgs; // Fit one full record
+            if (buf_size_ > 0xFFFF) buf_size_ = 0xFFFF;  // Record lengths are 16-bit
+            buf_ = new (std::nothrow) byte[buf_size_];
+        }
+
+        DeferredLogProxy(const DeferredLogProxy&) = delete;
+        DeferredLogProxy& operator=(const DeferredLogProxy&) = delete;
+
+        ~DeferredLogProxy() override {
+            delete[] buf_;
+        }
+
+        /**
+         * Store a printf-style record without formatting it.
+         * fmt and any %s arguments must outlive the record (use string literals).
+         * Returns false if the buffer could not be allocated.
+         */
+        template <typename... Args>
+        bool log(const char* fmt, Args... args) {
+            static_assert(sizeof...(Args) <= kMaxArgs, "DeferredLogProxy::log() supports at most kMaxArgs arguments");
+            const size_t tag_bytes = (sizeof...(Args) + 1) / 2;
+            const size_t len = kLogFixedSize + tag_bytes + ArgPack<Args...>::size;
+            size_t pos = reserve(len);
+            if (pos == kNone) return false;
+            byte* out = buf_ + pos + kHeaderSize;
+            uint32_t timestamp = millis();
+            uint32_t tags = ArgPack<Args...>::tags;
+            memcpy(out, &fmt, sizeof(fmt)); out += sizeof(fmt);
+            memcpy(out, &timestamp, 4); out += 4;
+            memcpy(out, &tags, tag_bytes); out += tag_bytes; // Little-endian: low nibbles first
+            encodeArgs(out, args...);
+            commit(pos, RECORD_LOG, static_cast<uint8_t>(sizeof...(Args)), len);
+            return true;
+        }
+
+        size_t write(uint8_t c) override {
+            appendText(&c, 1);
+            return 1;
+        }
+
+        size_t write(const uint8_t *buffer, size_t size) override {
+            if (!buffer || size == 0) return 0;
+            appendText(buffer, size);
+            return size;
+        }
+
+        using Print::write;
+
+        // Send pending records to Serial without blocking (bounded by Serial.availableForWrite()); returns bytes sent
+        size_t service(size_t max_bytes = SIZE_MAX) {
+            return drain(max_bytes, false);
+        }
+
+        // Send everything pending (blocking), then flush Serial
+        void flush() override {
+            drain(SIZE_MAX, true);
+            if (Serial) { Serial.flush(); }
+        }
+
+        std::string tail(size_t lines = 20) const override {
+            std::string out;
+            emitTail(lines, [&out](const uint8_t* data, size_t len) {
+                out.append(reinterpret_cast<const char*>(data), len);
+            });
+            return out;
+        }
+
+        // Streams the last lines, formatting records on the fly (no heap allocation)
+        size_t tail(Print& out, size_t lines = 20) const override {
+            size_t written = 0;
+            emitTail(lines, [&out, &written](const uint8_t* data, size_t len) {
+                written += out.write(data, len);
+            });
+            return written;
+        }
+
+        void clear() override {
+            head_ = tail_ = 0; wrapped_ = false; records_ = 0; last_text_ = kNone;
+            cursor_ = 0; cursor_offset_ = 0; pending_ = 0;
+        }
+
+        void setTimestamps(bool enable) { timestamps_ = enable; }
+        bool isTimestamps() const { return timestamps_; }
+
+        size_t records() const { return records_; }
+        size_t pending() const { return pending_; }
+        uint32_t droppedRecords() const { return dropped_; }
+        void resetDroppedRecords() { dropped_ = 0; }
+        size_t capacity() const { return buf_size_; }
+        size_t size() const {
+            if (records_ == 0) return 0;
+            return wrapped_ ? (wrap_end_ - tail_) + head_ : head_ - tail_;
+        }
+};
+
+#endif // HUB_DEFERRED_LOG_PROXY_HPP
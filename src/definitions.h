@@ -42,6 +42,11 @@
 class CachingPrinter : public Print {
     public: 
         virtual std::string tail(size_t lines = 20) const = 0;
+        // Streams the last lines into out without building a temporary string; returns bytes written
+        virtual size_t tail(Print& out, size_t lines = 20) const {
+            std::string text = tail(lines);
+            return out.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+        }
         virtual void clear() = 0;
 };
 
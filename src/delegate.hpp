@@ -0,0 +1,150 @@
+#ifndef HUB_DELEGATE_H
+#define HUB_DELEGATE_H
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Inline storage for captured state, in bytes. Two pointers fits [this], [&a, &b] or a (function, context) pair.
+#ifndef HUB_DELEGATE_CAPACITY
+#define HUB_DELEGATE_CAPACITY (2 * sizeof(void*))
+#endif
+
+template <typename Signature, size_t Capacity = HUB_DELEGATE_CAPACITY>
+class Delegate;
+
+/**
+ * @brief Non-allocating replacement for std::function used for library callbacks.
+ *
+ * The callable is stored in a fixed in-object buffer, so assigning a lambda never touches the heap.
+ * A callable that does not fit is rejected at compile time rather than silently allocating.
+ * The size is Capacity bytes plus one pointer, which is 12 bytes on ESP32 compared with 16 for
+ * std::function.
+ *
+ * @code
+ * Delegate<void(long)> cb = [this](long ms) { this->handle(ms); };
+ * Delegate<void(long)> raw(&onPress, &context);   // void onPress(void* context, long ms)
+ * if (cb) cb(42);
+ * @endcode
+ *
+ * @note Keep captures small: capture a pointer to a struct instead of several values.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class Delegate<R(Args...), Capacity> {
+    public:
+        typedef R (*ContextFunction)(void*, Args...);
+
+        Delegate() : ops(nullptr) {}
+        Delegate(std::nullptr_t) : ops(nullptr) {}
+
+        /**
+         * @brief Wrap a plain function pointer called with a user context as its first argument
+         */
+        Delegate(ContextFunction function, void* context) : ops(nullptr) {
+            if (function != nullptr) {
+                this->emplace(Bound{function, context});
+            }
+        }
+
+        /**
+         * @brief Wrap any callable (lambda, functor, function pointer) that fits in Capacity bytes
+         */
+        template <typename Callable,
+                  typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, Delegate>::value>::type>
+        Delegate(Callable&& callable) : ops(nullptr) {
+            this->emplace(std::forward<Callable>(callable));
+        }
+
+        Delegate(const Delegate& other) : ops(nullptr) {
+            this->copyFrom(other);
+        }
+
+        Delegate& operator=(const Delegate& other) {
+            if (this != &other) {
+                this->reset();
+                this->copyFrom(other);
+            }
+            return *this;
+        }
+
+        Delegate& operator=(std::nullptr_t) {
+            this->reset();
+            return *this;
+        }
+
+        ~Delegate() {
+            this->reset();
+        }
+
+        explicit operator bool() const {
+            return this->ops != nullptr;
+        }
+
+        R operator()(Args... args) const {
+            return this->ops->invoke(const_cast<void*>(static_cast<const void*>(&this->storage)), static_cast<Args&&>(args)...);
+        }
+
+        void reset() {
+            if (this->ops != nullptr) {
+                this->ops->destroy(&this->storage);
+                this->ops = nullptr;
+            }
+        }
+
+    private:
+        struct Ops {
+            R (*invoke)(void*, Args&&...);
+            void (*copy)(void* dst, const void* src);
+            void (*destroy)(void*);
+        };
+
+        struct Bound {
+            ContextFunction function;
+            void* context;
+            R operator()(Args... args) const { return this->function(this->context, static_cast<Args&&>(args)...); }
+        };
+
+        template <typename Callable>
+        struct Table {
+            static R invoke(void* target, Args&&... args) {
+                return (*static_cast<Callable*>(target))(static_cast<Args&&>(args)...);
+            }
+            static void copy(void* dst, const void* src) {
+                new (dst) Callable(*static_cast<const Callable*>(src));
+            }
+            static void destroy(void* target) {
+                static_cast<Callable*>(target)->~Callable();
+            }
+            static const Ops ops;
+        };
+
+        template <typename Callable>
+        void emplace(Callable&& callable) {
+            typedef typename std::decay<Callable>::type Stored;
+            static_assert(sizeof(Stored) <= Capacity, "Callable too large for Delegate: capture less, or use the (function, context) form");
+            static_assert(alignof(Stored) <= alignof(void*), "Callable alignment too strict for Delegate storage");
+            new (&this->storage) Stored(std::forward<Callable>(callable));
+            this->ops = &Table<Stored>::ops;
+        }
+
+        void copyFrom(const Delegate& other) {
+            if (other.ops != nullptr) {
+                other.ops->copy(&this->storage, &other.storage);
+                this->ops = other.ops;
+            }
+        }
+
+        typename std::aligned_storage<Capacity, alignof(void*)>::type storage;
+        const Ops* ops;
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename Callable>
+const typename Delegate<R(Args...), Capacity>::Ops Delegate<R(Args...), Capacity>::Table<Callable>::ops = {
+    &Delegate<R(Args...), Capacity>::Table<Callable>::invoke,
+    &Delegate<R(Args...), Capacity>::Table<Callable>::copy,
+    &Delegate<R(Args...), Capacity>::Table<Callable>::destroy,
+};
+
+#endif // HUB_DELEGATE_H
@@ -0,0 +1,233 @@
+/**
+ * @file fixed_shift_register.h
+ * @brief Compile-time specialized 74HC595 chain: FixedShiftRegister<NumRegisters, DataPin, ClockPin, LatchPin>.
+ *
+ * Features / design notes:
+ * - Same set/get/setMask/setByte/setValue/push_updates API as ShiftRegister.
+ * - The state is held in the smallest fitting integer (uint8_t for one chip, uint16_t for two,
+ *   uint32_t for three or four, uint64_t for five to eight), so a single-chip instance is 3 bytes.
+ *   Outputs beyond NumRegisters * 8 are masked off.
+ * - The shift loop is unrolled at compile time, one step per output.
+ * - On ESP32 the pins drive the GPIO set/clear (W1TS/W1TC) registers directly, with the register
+ *   addresses and pin masks resolved as constants; other platforms use digitalWrite with constant pins.
+ * - Use the runtime ShiftRegister when the chain length or pins are only known at runtime
+ *   or when the SPI backend is needed.
+ */
+
+#ifndef HUB_FIXED_SHIFT_REGISTER_H
+#define HUB_FIXED_SHIFT_REGISTER_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/gpio_struct.h>
+#include <soc/soc_caps.h>
+#endif
+
+// Smallest unsigned integer holding NumRegisters * 8 outputs
+template <uint8_t NumRegisters> struct FixedShiftRegisterWord { typedef uint64_t type; };
+template <> struct FixedShiftRegisterWord<1> { typedef uint8_t type; };
+template <> struct FixedShiftRegisterWord<2> { typedef uint16_t type; };
+template <> struct FixedShiftRegisterWord<3> { typedef uint32_t type; };
+template <> struct FixedShiftRegisterWord<4> { typedef uint32_t type; };
+
+// Emits Bits clock steps, MSB first, fully unrolled
+template <uint8_t Bits>
+struct FixedShiftRegisterUnroll {
+    template <typename Owner, typename Word>
+    static inline void shift(Word value) {
+        Owner::shiftBit(((value >> (Bits - 1)) & 1) != 0);
+        FixedShiftRegisterUnroll<Bits - 1>::template shift<Owner>(value);
+    }
+};
+
+template <>
+struct FixedShiftRegisterUnroll<0> {
+    template <typename Owner, typename Word>
+    static inline void shift(Word) {}
+};
+
+template <uint8_t NumRegisters, uint8_t DataPin, uint8_t ClockPin, uint8_t LatchPin>
+class FixedShiftRegister {
+        static_assert(NumRegisters >= 1 && NumRegisters <= 8, "FixedShiftRegister supports 1-8 cascaded registers");
+        #if defined(ARDUINO_ARCH_ESP32)
+        static_assert(DataPin < SOC_GPIO_PIN_COUNT && ClockPin < SOC_GPIO_PIN_COUNT && LatchPin < SOC_GPIO_PIN_COUNT,
+                      "FixedShiftRegister pin out of range for this chip");
+        #endif
+
+    public:
+        typedef typename FixedShiftRegisterWord<NumRegisters>::type value_type;
+        static constexpr uint8_t kNumBits = NumRegisters * 8;
+        static constexpr value_type kValidMask =
+            static_cast<value_type>(kNumBits >= 64 ? ~0ULL : ((1ULL << (kNumBits & 63)) - 1));
+
+        FixedShiftRegister() : val(0), last_latched(0), dirty(false), skip_unchanged(false), has_latched(false) {
+            // Initialize pins
+            pinMode(DataPin, OUTPUT);
+            pinMode(ClockPin, OUTPUT);
+            pinMode(LatchPin, OUTPUT);
+
+            // Ensure outputs start in known state (all LOW)
+            digitalWrite(DataPin, LOW);
+            digitalWrite(ClockPin, LOW);
+            digitalWrite(LatchPin, LOW);
+        }
+
+        bool set(uint8_t index, bool value, bool update = true) {
+            if (index >= kNumBits) {
+                return false;
+            }
+            const value_type mask = static_cast<value_type>(static_cast<value_type>(1) << index);
+            if (value) {
+                this->val |= mask;
+            } else {
+                this->val &= static_cast<value_type>(~mask);
+            }
+            this->dirty = true;
+            if (update) {
+                this->push_updates();
+            }
+            return true;
+        }
+
+        void setAll(bool value) {
+            this->val = value ? kValidMask : 0;
+            this->dirty = true;
+            this->push_updates();
+        }
+
+        void clear() {
+            this->setAll(false);
+        }
+
+        /**
+         * @brief Set every output selected by mask to the matching bit in values (deferred until push_updates()).
+         */
+        void setMask(value_type mask, value_type values) {
+            mask &= kValidMask;
+            this->val = static_cast<value_type>((this->val & ~mask) | (values & mask));
+            this->dirty = true;
+        }
+
+        /**
+         * @brief Set all 8 outputs of one register (deferred until push_updates()).
+         * @return false if reg is out of range
+         */
+        bool setByte(uint8_t reg, uint8_t value) {
+            if (reg >= NumRegisters) {
+                return false;
+            }
+            const uint8_t shift = reg * 8;
+            this->val = static_cast<value_type>((this->val & ~(static_cast<value_type>(0xFF) << shift)) |
+                                                (static_cast<value_type>(value) << shift));
+            this->dirty = true;
+            return true;
+        }
+
+        /**
+         * @brief Replace the whole output state (deferred until push_updates()).
+         */
+        void setValue(value_type value) {
+            this->val = value & kValidMask;
+            this->dirty = true;
+        }
+
+        void push_updates(bool force = false) {
+            if (!force) {
+                if (!this->dirty) {
+                    return;
+                }
+                if (this->skip_unchanged && this->has_latched && this->val == this->last_latched) {
+                    // Outputs already show this state; no need to shift it out again
+                    this->dirty = false;
+                    return;
+                }
+            }
+            this->update();
+        }
+
+        /**
+         * @brief When enabled, pushes skip the latch entirely if the state matches the value last latched.
+         */
+        void setSkipUnchanged(bool enabled) { skip_unchanged = enabled; }
+        bool isSkipUnchanged() const { return skip_unchanged; }
+
+        // Query methods for testing and debugging
+        bool get(uint8_t index) const {
+            if (index >= kNumBits) {
+                return false;
+            }
+            return ((this->val >> index) & 1) != 0;
+        }
+        static constexpr uint8_t getNumBits() { return kNumBits; }
+        static constexpr uint8_t getNumRegisters() { return NumRegisters; }
+        value_type getValue() const { return val; }
+        bool isDirty() const { return dirty; }
+
+    private:
+        value_type val;
+        value_type last_latched;  // Value most recently latched to the outputs (valid when has_latched)
+        bool dirty : 1;
+        bool skip_unchanged : 1;
+        bool has_latched : 1;
+
+        template <uint8_t> friend struct FixedShiftRegisterUnroll;
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        // Bank registers are selected by the (constant) pin number, so these fold to a single store
+        template <uint8_t Pin>
+        static inline void pinHigh() {
+            #if SOC_GPIO_PIN_COUNT > 32
+            if (Pin >= 32) { GPIO.out1_w1ts.val = 1UL << (Pin & 31); return; }
+            #endif
+            GPIO.out_w1ts = 1UL << (Pin & 31);
+        }
+
+        template <uint8_t Pin>
+        static inline void pinLow() {
+            #if SOC_GPIO_PIN_COUNT > 32
+            if (Pin >= 32) { GPIO.out1_w1tc.val = 1UL << (Pin & 31); return; }
+            #endif
+            GPIO.out_w1tc = 1UL << (Pin & 31);
+        }
+        #else
+        template <uint8_t Pin>
+        static inline void pinHigh() { digitalWrite(Pin, HIGH); }
+
+        template <uint8_t Pin>
+        static inline void pinLow() { digitalWrite(Pin, LOW); }
+        #endif
+
+        static inline void shiftBit(bool bit) {
+            pinLow<ClockPin>();
+            if (bit) {
+                pinHigh<DataPin>();
+            } else {
+                pinLow<DataPin>();
+            }
+            // Clock pulse to shift in the bit
+            pinHigh<ClockPin>();
+        }
+
+        void update() {
+            // Shift out MSB first (highest register first), then latch to the outputs
+            pinLow<LatchPin>();
+            FixedShiftRegisterUnroll<kNumBits>::template shift<FixedShiftRegister>(this->val);
+            // Final state: leave clock high, data low for consistency
+            pinLow<DataPin>();
+            pinHigh<LatchPin>();
+
+            this->dirty = false;
+            this->last_latched = this->val;
+            this->has_latched = true;
+        }
+};
+
+template <uint8_t NumRegisters, uint8_t DataPin, uint8_t ClockPin, uint8_t LatchPin>
+constexpr uint8_t FixedShiftRegister<NumRegisters, DataPin, ClockPin, LatchPin>::kNumBits;
+
+template <uint8_t NumRegisters, uint8_t DataPin, uint8_t ClockPin, uint8_t LatchPin>
+constexpr typename FixedShiftRegister<NumRegisters, DataPin, ClockPin, LatchPin>::value_type
+    FixedShiftRegister<NumRegisters, DataPin, ClockPin, LatchPin>::kValidMask;
+
+#endif  // HUB_FIXED_SHIFT_REGISTER_H
@@ -4,46 +4,402 @@
 #include <Wire.h>
 #include <Arduino.h>
 #include "definitions.h"
+#include "delegate.hpp"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <Preferences.h>
+#endif
 
 /**
  * @file i2c_utils.hpp
  * @brief Utility helpers for working with I2C devices.
  *
- * This header currently provides a flexible bus scanning helper. It is kept header-only and
+ * This header provides a flexible bus scanning helper and I2CBus, a shared bus manager that
+ * serializes (and optionally queues) transactions from multiple tasks. It is kept header-only and
  * marked inline for zero linkage overhead when used in multiple translation units.
  */
 
+#if defined(ARDUINO_ARCH_ESP32) && defined(SOC_I2C_NUM) && SOC_I2C_NUM > 1
+#define HUB_I2C_HAS_SECONDARY_BUS 1
+#endif
+
+class I2CBus;
+
 /**
- * @brief Scan an I2C bus for device addresses.
- *
- * This function probes each address in the specified range and reports devices that ACK.
- * It is designed for efficiency and flexibility on ESP32 / Arduino platforms, allowing
- * customization of address range, inter-probe delay, error reporting, and target wire bus.
- *
- * Typical valid 7-bit I2C address range is 0x08 - 0x77 (below 0x08 are mostly reserved).
+ * @brief One queued I2C transaction: a write, a read, or a write followed by a repeated-start read.
  *
- * @param printer        Optional Print target for human-readable output (defaults to Serial if available).
- * @param wire           Reference to the TwoWire bus to scan (defaults to global Wire).
- * @param startAddress   First address to test (inclusive). Defaults to 0x08 to skip reserved addresses.
- * @param endAddress     Last address to test (inclusive). Defaults to 0x77 (maximum 7-bit address).
- * @param delayMicros    Microseconds delay between probes. Kept short (default 20µs) to minimize total scan time.
- * @param showErrors     If true, prints addresses that return error code 4 (other error codes are silently ignored).
- * @param foundCallback  Optional callback invoked for each found address (receives the 7-bit address).
+ * The caller owns the transaction and its tx/rx buffers. I2CBus::submit() links it into the bus
+ * queue without allocating; it must stay alive (and untouched) until it completes.
+ */
+struct I2CTransaction {
+    static const uint8_t STATUS_PENDING = 0xFF;
+
+    uint8_t address = 0;                        ///< 7-bit device address
+    uint8_t priority = 0;                       ///< Higher values are served first
+    const uint8_t* tx = nullptr;                ///< Bytes to write (e.g. register index), may be null
+    size_t txLength = 0;
+    uint8_t* rx = nullptr;                      ///< Destination for read bytes, may be null
+    size_t rxLength = 0;
+    Delegate<void(I2CTransaction&)> onComplete; ///< Optional, called from the servicing context
+    volatile uint8_t status = 0;                ///< endTransmission() code, I2CBus::STATUS_SHORT_READ, or STATUS_PENDING
+
+    /** @brief True once the transaction has run (check status for the result). */
+    bool done() const { return status != STATUS_PENDING; }
+
+  private:
+    I2CTransaction* next = nullptr;
+    friend class I2CBus;
+};
+
+/**
+ * @brief Shared I2C bus manager wrapping one TwoWire controller.
  *
- * @return int           Number of devices that acknowledged in the range.
+ * Drivers (ADS7828, LIS3DH, scan_i2c) can target an I2CBus instead of the raw global Wire so that
+ * several FreeRTOS tasks can share the bus safely:
+ *  - Blocking calls (transfer/write/read/writeRead/probe) run a whole transaction, including the
+ *    repeated start of a register read, under a recursive mutex. Waiting tasks are woken in task
+ *    priority order (FreeRTOS mutex semantics, with priority inheritance).
+ *  - Lock (or lock()/unlock()) holds the bus across a multi-transaction sequence.
+ *  - submit() queues caller-owned transactions in priority order; service() (or the ESP32 worker task)
+ *    runs them, keeping consecutive transactions to the same device together within a priority level.
+ *  - primary() / secondary() expose Wire and, on dual-controller chips such as the ESP32-S3, Wire1,
+ *    so drivers can be split across buses.
  *
- * @note You should call wire.begin() before invoking this scan.
- * @note A yield() is performed periodically to keep the watchdog serviced on ESP platforms.
+ * On non-ESP32 platforms the locking compiles away (single-threaded) and the queue is served by service().
  */
-inline int scan_i2c(
-    Print* printer = nullptr,
-    TwoWire& wire = Wire,
-    uint8_t startAddress = 0x08,
-    uint8_t endAddress   = 0x77,
-    uint16_t delayMicros = 20,
-    bool showErrors = false,
-    void (*foundCallback)(uint8_t address) = nullptr
-) {
+class I2CBus {
+    public:
+        static const uint8_t STATUS_SHORT_READ = 0xFE; ///< The device returned fewer bytes than requested
+
+        /**
+         * @brief RAII guard holding the bus for a multi-transaction sequence.
+         */
+        class Lock {
+            public:
+                explicit Lock(I2CBus& bus) : bus_(bus) { bus_.lock(); }
+                ~Lock() { bus_.unlock(); }
+                Lock(const Lock&) = delete;
+                Lock& operator=(const Lock&) = delete;
+            private:
+                I2CBus& bus_;
+        };
+
+        explicit I2CBus(TwoWire& wire = Wire) : wire_(wire) {
+#if defined(ARDUINO_ARCH_ESP32)
+            mutex_ = xSemaphoreCreateRecursiveMutex();
+#endif
+        }
+
+        ~I2CBus() {
+            stopWorkerTask();
+#if defined(ARDUINO_ARCH_ESP32)
+            if (mutex_ != nullptr) {
+                vSemaphoreDelete(mutex_);
+            }
+#endif
+        }
+
+        I2CBus(const I2CBus&) = delete;
+        I2CBus& operator=(const I2CBus&) = delete;
+
+        /** @brief Shared manager for the global Wire controller. */
+        static I2CBus& primary() {
+            static I2CBus bus(Wire);
+            return bus;
+        }
+
+#if defined(HUB_I2C_HAS_SECONDARY_BUS)
+        /** @brief Shared manager for the second controller (Wire1) on chips that have one. */
+        static I2CBus& secondary() {
+            static I2CBus bus(Wire1);
+            return bus;
+        }
+#endif
+
+        /**
+         * @brief Start the controller with its default pins (idempotent).
+         *
+         * Drivers call this from their own begin(), so it only initialises the controller once.
+         */
+        void begin() {
+            Lock guard(*this);
+            if (!begun_) {
+                wire_.begin();
+                begun_ = true;
+            }
+        }
+
+#if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Start the controller on specific pins (required for the second controller).
+         *
+         * @param sda        SDA GPIO
+         * @param scl        SCL GPIO
+         * @param frequency  Bus clock in Hz (0 keeps the core default, normally 100kHz)
+         * @return true if the controller started
+         */
+        bool begin(int sda, int scl, uint32_t frequency = 0) {
+            Lock guard(*this);
+            begun_ = wire_.begin(sda, scl, frequency);
+            return begun_;
+        }
+#endif
+
+        /** @brief The underlying controller (hold a Lock while using it directly). */
+        TwoWire& wire() { return wire_; }
+
+        /** @brief Take the bus (recursive, so transactions may be issued while held). */
+        void lock() {
+#if defined(ARDUINO_ARCH_ESP32)
+            xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+#endif
+        }
+
+        /** @brief Release the bus taken by lock(). */
+        void unlock() {
+#if defined(ARDUINO_ARCH_ESP32)
+            xSemaphoreGiveRecursive(mutex_);
+#endif
+        }
+
+        /**
+         * @brief Run one transaction atomically: optional write, then optional read with a repeated start.
+         *
+         * @param address   7-bit device address
+         * @param tx        Bytes to write (may be null when txLength is 0)
+         * @param txLength  Number of bytes to write
+         * @param rx        Destination buffer for the read (may be null when rxLength is 0)
+         * @param rxLength  Number of bytes to read (at most the Wire buffer size, typically 32-128)
+         * @return 0 on success, the endTransmission() error code (1-5), or STATUS_SHORT_READ
+         *
+         * @note With both lengths 0 this is an address probe.
+         */
+        uint8_t transfer(uint8_t address, const uint8_t* tx, size_t txLength, uint8_t* rx, size_t rxLength) {
+            Lock guard(*this);
+            uint8_t status = 0;
+
+            if (txLength > 0 || rxLength == 0) {
+                wire_.beginTransmission(address);
+                if (txLength > 0) {
+                    wire_.write(tx, txLength);
+                }
+                // Keep the bus for the read phase (repeated start) so no other master can slip in
+                status = wire_.endTransmission(rxLength == 0);
+            }
+
+            if (status == 0 && rxLength > 0) {
+                wire_.requestFrom(address, static_cast<uint8_t>(rxLength));
+                size_t received = 0;
+                while (received < rxLength && wire_.available()) {
+                    rx[received++] = static_cast<uint8_t>(wire_.read());
+                }
+                if (received < rxLength) {
+                    status = STATUS_SHORT_READ;
+                }
+            }
+
+            ++transactions_;
+            if (status != 0) {
+                ++errors_;
+            }
+            return status;
+        }
+
+        /** @brief Write bytes to a device. @return 0 on success or an error code (see transfer()) */
+        uint8_t write(uint8_t address, const uint8_t* data, size_t length) {
+            return transfer(address, data, length, nullptr, 0);
+        }
+
+        /** @brief Read bytes from a device. @return 0 on success or an error code (see transfer()) */
+        uint8_t read(uint8_t address, uint8_t* data, size_t length) {
+            return transfer(address, nullptr, 0, data, length);
+        }
+
+        /** @brief Write a register index then read its contents with a repeated start. */
+        uint8_t writeRead(uint8_t address, const uint8_t* tx, size_t txLength, uint8_t* rx, size_t rxLength) {
+            return transfer(address, tx, txLength, rx, rxLength);
+        }
+
+        /** @brief Address-only probe. @return 0 if the device ACKed, otherwise the endTransmission() code */
+        uint8_t probe(uint8_t address) {
+            return transfer(address, nullptr, 0, nullptr, 0);
+        }
+
+        /**
+         * @brief Queue a transaction to be run by service() or the worker task.
+         *
+         * Transactions are ordered by priority (highest first, FIFO within a level). The transaction
+         * must not be modified until done() is true or, when onComplete is set, until the callback runs.
+         *
+         * @return false if the transaction is already queued
+         */
+        bool submit(I2CTransaction& transaction) {
+            queueEnter();
+            if (transaction.status == I2CTransaction::STATUS_PENDING) {
+                queueExit();
+                return false;
+            }
+            transaction.status = I2CTransaction::STATUS_PENDING;
+            transaction.next = nullptr;
+
+            I2CTransaction** link = &queue_;
+            while (*link != nullptr && (*link)->priority >= transaction.priority) {
+                link = &(*link)->next;
+            }
+            transaction.next = *link;
+            *link = &transaction;
+            ++queued_;
+            queueExit();
+
+#if defined(ARDUINO_ARCH_ESP32)
+            TaskHandle_t worker = worker_;
+            if (worker != nullptr) {
+                xTaskNotifyGive(worker);
+            }
+#endif
+            return true;
+        }
+
+        /**
+         * @brief Run queued transactions.
+         *
+         * After each transaction the next one to the same device at the same priority level (if any)
+         * is run before moving on, so per-device sequences are batched back to back.
+         *
+         * @param max  Maximum number of transactions to run (0 = until the queue is empty)
+         * @return Number of transactions run
+         */
+        size_t service(size_t max = 0) {
+            size_t count = 0;
+            int lastAddress = -1;
+            while (max == 0 || count < max) {
+                I2CTransaction* transaction = dequeue(lastAddress);
+                if (transaction == nullptr) {
+                    break;
+                }
+                const uint8_t status = transfer(transaction->address, transaction->tx, transaction->txLength,
+                                                transaction->rx, transaction->rxLength);
+                lastAddress = transaction->address;
+                transaction->status = status;
+                if (transaction->onComplete) {
+                    transaction->onComplete(*transaction);
+                }
+                ++count;
+            }
+            return count;
+        }
+
+        /** @brief Number of queued transactions not yet run. */
+        size_t pending() const { return queued_; }
+
+        /** @brief Transactions run since construction (blocking and queued). */
+        uint32_t transactionCount() const { return transactions_; }
+
+        /** @brief Transactions that ended with a non-zero status. */
+        uint32_t errorCount() const { return errors_; }
+
+#if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Serve the queue from a dedicated FreeRTOS task, woken by submit().
+         *
+         * Give it a higher priority than the tasks that submit, so that queued low-latency reads
+         * run as soon as the bus is free.
+         */
+        bool startWorkerTask(UBaseType_t priority = 5, uint32_t stack_size = 3072, BaseType_t core = tskNO_AFFINITY) {
+            if (worker_ != nullptr) return true;
+            worker_stop_ = false;
+            TaskHandle_t handle = nullptr;
+            if (xTaskCreatePinnedToCore(workerTaskEntry, "i2c_bus", stack_size, this, priority, &handle, core) != pdPASS) {
+                return false;
+            }
+            worker_ = handle;
+            // Anything queued before the task existed
+            xTaskNotifyGive(handle);
+            return true;
+        }
+
+        /** @brief Ask the worker task to exit and wait for it (queued work stays for service()). */
+        void stopWorkerTask() {
+            if (worker_ == nullptr) return;
+            worker_stop_ = true;
+            xTaskNotifyGive(worker_);
+            while (worker_ != nullptr) { vTaskDelay(1); }
+        }
+
+        bool isWorkerTaskRunning() const { return worker_ != nullptr; }
+#else
+        void stopWorkerTask() {}
+#endif
+
+    private:
+        TwoWire& wire_;
+        bool begun_ = false;
+        I2CTransaction* queue_ = nullptr;
+        volatile size_t queued_ = 0;
+        uint32_t transactions_ = 0;
+        uint32_t errors_ = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+        SemaphoreHandle_t mutex_ = nullptr;
+        portMUX_TYPE queue_mux_ = portMUX_INITIALIZER_UNLOCKED;
+        volatile TaskHandle_t worker_ = nullptr;
+        volatile bool worker_stop_ = false;
+
+        static void workerTaskEntry(void* arg) {
+            I2CBus* self = static_cast<I2CBus*>(arg);
+            while (!self->worker_stop_) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                if (self->worker_stop_) break;
+                self->service();
+            }
+            self->worker_ = nullptr;
+            vTaskDelete(nullptr);
+        }
+#endif
+
+        void queueEnter() {
+#if defined(ARDUINO_ARCH_ESP32)
+            portENTER_CRITICAL(&queue_mux_);
+#endif
+        }
+
+        void queueExit() {
+#if defined(ARDUINO_ARCH_ESP32)
+            portEXIT_CRITICAL(&queue_mux_);
+#endif
+        }
+
+        // Unlink the next transaction: the first one to lastAddress within the head's priority level, else the head
+        I2CTransaction* dequeue(int lastAddress) {
+            queueEnter();
+            I2CTransaction** link = &queue_;
+            if (queue_ != nullptr && lastAddress >= 0) {
+                for (I2CTransaction** scan = &queue_; *scan != nullptr && (*scan)->priority == queue_->priority; scan = &(*scan)->next) {
+                    if ((*scan)->address == lastAddress) {
+                        link = scan;
+                        break;
+                    }
+                }
+            }
+            I2CTransaction* transaction = *link;
+            if (transaction != nullptr) {
+                *link = transaction->next;
+                transaction->next = nullptr;
+                --queued_;
+            }
+            queueExit();
+            return transaction;
+        }
+};
+
+namespace HubI2CDetail {
+
+// Shared body of the scan_i2c() overloads; probe(address) returns the endTransmission() code
+template <typename Probe>
+inline int scan(Print* printer, Probe probe, uint8_t startAddress, uint8_t endAddress,
+                uint16_t delayMicros, bool showErrors, void (*foundCallback)(uint8_t address)) {
     if (startAddress > endAddress) {
         // Invalid range; nothing to do
         return 0;
@@ -75,9 +431,7 @@ inline int scan_i2c(
             delayMicroseconds(delayMicros);
         }
 
-        wire.beginTransmission(static_cast<uint8_t>(address));
-        // Use a repeated start where possible to avoid releasing the bus unnecessarily.
-        uint8_t error = wire.endTransmission(true);
+        uint8_t error = probe(static_cast<uint8_t>(address));
 
         if (error == 0) {
             ++devicesFound;
@@ -119,4 +473,266 @@ inline int scan_i2c(
     return devicesFound;
 }
 
+} // namespace HubI2CDetail
+
+/**
+ * @brief Scan an I2C bus for device addresses.
+ *
+ * This function probes each address in the specified range and reports devices that ACK.
+ * It is designed for efficiency and flexibility on ESP32 / Arduino platforms, allowing
+ * customization of address range, inter-probe delay, error reporting, and target wire bus.
+ *
+ * Typical valid 7-bit I2C address range is 0x08 - 0x77 (below 0x08 are mostly reserved).
+ *
+ * @param printer        Optional Print target for human-readable output (defaults to Serial if available).
+ * @param wire           Reference to the TwoWire bus to scan (defaults to global Wire).
+ * @param startAddress   First address to test (inclusive). Defaults to 0x08 to skip reserved addresses.
+ * @param endAddress     Last address to test (inclusive). Defaults to 0x77 (maximum 7-bit address).
+ * @param delayMicros    Microseconds delay between probes. Kept short (default 20µs) to minimize total scan time.
+ * @param showErrors     If true, prints addresses that return error code 4 (other error codes are silently ignored).
+ * @param foundCallback  Optional callback invoked for each found address (receives the 7-bit address).
+ *
+ * @return int           Number of devices that acknowledged in the range.
+ *
+ * @note You should call wire.begin() before invoking this scan.
+ * @note A yield() is performed periodically to keep the watchdog serviced on ESP platforms.
+ */
+inline int scan_i2c(
+    Print* printer = nullptr,
+    TwoWire& wire = Wire,
+    uint8_t startAddress = 0x08,
+    uint8_t endAddress   = 0x77,
+    uint16_t delayMicros = 20,
+    bool showErrors = false,
+    void (*foundCallback)(uint8_t address) = nullptr
+) {
+    return HubI2CDetail::scan(printer, [&wire](uint8_t address) -> uint8_t {
+        wire.beginTransmission(address);
+        return wire.endTransmission(true);
+    }, startAddress, endAddress, delayMicros, showErrors, foundCallback);
+}
+
+/**
+ * @brief Scan an I2CBus for device addresses.
+ *
+ * Same as scan_i2c(Print*, TwoWire&, ...) but each probe is a bus transaction, so the scan
+ * interleaves safely with other tasks using the bus instead of holding it for the whole sweep.
+ *
+ * @param printer  Optional Print target for human-readable output (defaults to Serial if available).
+ * @param bus      Bus manager to scan (e.g. I2CBus::primary()); call bus.begin() first.
+ *
+ * @return int     Number of devices that acknowledged in the range.
+ */
+inline int scan_i2c(
+    Print* printer,
+    I2CBus& bus,
+    uint8_t startAddress = 0x08,
+    uint8_t endAddress   = 0x77,
+    uint16_t delayMicros = 20,
+    bool showErrors = false,
+    void (*foundCallback)(uint8_t address) = nullptr
+) {
+    return HubI2CDetail::scan(printer, [&bus](uint8_t address) -> uint8_t {
+        return bus.probe(address);
+    }, startAddress, endAddress, delayMicros, showErrors, foundCallback);
+}
+
+
+/**
+ * @brief Compact 128-bit presence bitmap of 7-bit I2C addresses.
+ *
+ * Bit N is set when a device ACKed at address N. 16 bytes regardless of how many devices are present,
+ * so it is cheap to return by value, compare, and persist.
+ */
+struct I2CDeviceMap {
+    uint32_t bits[4] = {0, 0, 0, 0};
+
+    /** @brief True if a device is present at address. */
+    bool has(uint8_t address) const {
+        return address < 128 && ((bits[address >> 5] >> (address & 31)) & 1u) != 0;
+    }
+
+    void set(uint8_t address) {
+        if (address < 128) bits[address >> 5] |= 1u << (address & 31);
+    }
+
+    void reset(uint8_t address) {
+        if (address < 128) bits[address >> 5] &= ~(1u << (address & 31));
+    }
+
+    void clear() {
+        bits[0] = bits[1] = bits[2] = bits[3] = 0;
+    }
+
+    /** @brief Number of devices present. */
+    uint8_t count() const {
+        return static_cast<uint8_t>(__builtin_popcount(bits[0]) + __builtin_popcount(bits[1]) +
+                                    __builtin_popcount(bits[2]) + __builtin_popcount(bits[3]));
+    }
+
+    bool empty() const { return (bits[0] | bits[1] | bits[2] | bits[3]) == 0; }
+
+    /**
+     * @brief Lowest present address greater than after, or -1 if none.
+     *
+     * Iterate with: for (int a = map.next(); a >= 0; a = map.next(a)) { ... }
+     */
+    int next(int after = -1) const {
+        for (int address = after + 1; address < 128; ) {
+            const uint32_t word = bits[address >> 5] >> (address & 31);
+            if (word != 0) {
+                return address + __builtin_ctz(word);
+            }
+            address = (address | 31) + 1;
+        }
+        return -1;
+    }
+
+    bool operator==(const I2CDeviceMap& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2] && bits[3] == other.bits[3];
+    }
+
+    bool operator!=(const I2CDeviceMap& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Silently probe an address range and return the presence bitmap.
+ *
+ * Unlike scan_i2c() there is no printing, callback, or inter-probe delay; each probe is one I2CBus
+ * transaction, so other tasks can still use the bus between probes.
+ *
+ * @param bus           Bus to scan (call bus.begin() first)
+ * @param startAddress  First address (inclusive), default 0x08
+ * @param endAddress    Last address (inclusive), default 0x77
+ * @return Bitmap of addresses that ACKed
+ */
+inline I2CDeviceMap scan_i2c_map(I2CBus& bus, uint8_t startAddress = 0x08, uint8_t endAddress = 0x77) {
+    I2CDeviceMap map;
+    for (uint16_t address = startAddress; address <= endAddress && address < 128; ++address) {
+        if (bus.probe(static_cast<uint8_t>(address)) == 0) {
+            map.set(static_cast<uint8_t>(address));
+        }
+    }
+    return map;
+}
+
+/**
+ * @brief Probe only the addresses set in expected.
+ *
+ * @return The subset of expected that still ACKs
+ */
+inline I2CDeviceMap reprobe_i2c(I2CBus& bus, const I2CDeviceMap& expected) {
+    I2CDeviceMap map;
+    for (int address = expected.next(); address >= 0; address = expected.next(address)) {
+        if (bus.probe(static_cast<uint8_t>(address)) == 0) {
+            map.set(static_cast<uint8_t>(address));
+        }
+    }
+    return map;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+namespace HubI2CDetail {
+
+struct ParallelScanJob {
+    I2CBus* bus;
+    I2CDeviceMap* map;
+    uint8_t startAddress;
+    uint8_t endAddress;
+    SemaphoreHandle_t done;
+};
+
+inline void parallelScanTask(void* arg) {
+    ParallelScanJob* job = static_cast<ParallelScanJob*>(arg);
+    *job->map = scan_i2c_map(*job->bus, job->startAddress, job->endAddress);
+    xSemaphoreGive(job->done);
+    vTaskDelete(nullptr);
+}
+
+} // namespace HubI2CDetail
+#endif
+
+/**
+ * @brief Scan two buses at the same time (e.g. both ESP32-S3 controllers).
+ *
+ * The second bus is scanned from a short-lived helper task while the calling task scans the first,
+ * so the total time is that of the slower bus instead of the sum. Falls back to scanning one after
+ * the other if the task cannot be created, and on non-ESP32 platforms.
+ *
+ * @param first      First bus (scanned by the calling task)
+ * @param firstMap   Receives the first bus's presence bitmap
+ * @param second     Second bus; must wrap a different controller than first
+ * @param secondMap  Receives the second bus's presence bitmap
+ * @param helperStackSize Stack size in bytes of the helper task; the Wire driver needs about as much as the bus worker's
+ */
+inline void scan_i2c_parallel(I2CBus& first, I2CDeviceMap& firstMap, I2CBus& second, I2CDeviceMap& secondMap,
+                              uint8_t startAddress = 0x08, uint8_t endAddress = 0x77, uint32_t helperStackSize = 3072) {
+#if defined(ARDUINO_ARCH_ESP32)
+    HubI2CDetail::ParallelScanJob job = { &second, &secondMap, startAddress, endAddress, xSemaphoreCreateBinary() };
+    if (job.done != nullptr) {
+        if (xTaskCreatePinnedToCore(HubI2CDetail::parallelScanTask, "i2c_scan", helperStackSize, &job,
+                                    uxTaskPriorityGet(nullptr), nullptr, tskNO_AFFINITY) == pdPASS) {
+            firstMap = scan_i2c_map(first, startAddress, endAddress);
+            xSemaphoreTake(job.done, portMAX_DELAY);
+            vSemaphoreDelete(job.done);
+            return;
+        }
+        vSemaphoreDelete(job.done);
+    }
+#endif
+    firstMap = scan_i2c_map(first, startAddress, endAddress);
+    secondMap = scan_i2c_map(second, startAddress, endAddress);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Scan with a device map cached in NVS (Preferences namespace "hubi2c").
+ *
+ * Warm path: if a map is cached under key, only its addresses are re-probed. If they all still
+ * ACK, the cached map is returned without a full scan. Otherwise (or with no cache, or
+ * forceFull) the full range is scanned and the cache is rewritten when the result changed.
+ *
+ * @param bus        Bus to scan
+ * @param key        NVS key for this bus (max 15 characters, e.g. "bus0")
+ * @param forceFull  Always do a full scan (e.g. after adding hardware)
+ * @return Presence bitmap
+ *
+ * @note Devices added since the map was cached are only found by a full scan.
+ */
+inline I2CDeviceMap scan_i2c_cached(I2CBus& bus, const char* key, bool forceFull = false,
+                                    uint8_t startAddress = 0x08, uint8_t endAddress = 0x77) {
+    I2CDeviceMap cached;
+    bool haveCache = false;
+    Preferences prefs;
+    if (prefs.begin("hubi2c", true)) {
+        haveCache = prefs.getBytes(key, cached.bits, sizeof(cached.bits)) == sizeof(cached.bits);
+        prefs.end();
+    }
+
+    if (haveCache && !forceFull && !cached.empty()) {
+        if (reprobe_i2c(bus, cached) == cached) {
+            return cached;
+        }
+    }
+
+    I2CDeviceMap map = scan_i2c_map(bus, startAddress, endAddress);
+    if (!haveCache || map != cached) {
+        if (prefs.begin("hubi2c", false)) {
+            prefs.putBytes(key, map.bits, sizeof(map.bits));
+            prefs.end();
+        }
+    }
+    return map;
+}
+
+/** @brief Forget the map cached by scan_i2c_cached() under key. */
+inline void clear_i2c_cache(const char* key) {
+    Preferences prefs;
+    if (prefs.begin("hubi2c", false)) {
+        prefs.remove(key);
+        prefs.end();
+    }
+}
+#endif
+
 #endif // HUB_I2C_UTILS_H
\ No newline at end of file
@@ -2,9 +2,22 @@
 #define HUB_MEMORY_UTILS_H
 
 #include <Arduino.h>
+#include <cstddef>
+#include <new>
 
 #if defined(ARDUINO_ARCH_ESP32)
+  #include <freertos/FreeRTOS.h>
   #include <esp_heap_caps.h>
+  #if defined(CONFIG_HEAP_TRACING_STANDALONE)
+    #include <esp_heap_trace.h>
+  #endif
+#endif
+
+// Per-tag attribution via the ESP-IDF standalone heap tracer (see HeapTagScope)
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_HEAP_TRACING_STANDALONE)
+  #define HUB_MEMORY_HAS_HEAP_TRACE 1
+#else
+  #define HUB_MEMORY_HAS_HEAP_TRACE 0
 #endif
 
 /**
@@ -156,6 +169,784 @@ namespace HubMemoryUtils {
     #endif
   }
 
+  // ---------------------------------------------------------------------------
+  // Per-capability statistics
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Heap regions tracked by capsStats() and HeapSampler.
+   *
+   * - HEAP_DEFAULT:  whatever malloc()/new draw from (MALLOC_CAP_DEFAULT)
+   * - HEAP_INTERNAL: on-chip 8-bit capable RAM
+   * - HEAP_PSRAM:    external SPI RAM (zero when none is fitted)
+   * - HEAP_DMA:      DMA-capable RAM
+   */
+  enum HeapRegion : uint8_t {
+    HEAP_DEFAULT = 0,
+    HEAP_INTERNAL,
+    HEAP_PSRAM,
+    HEAP_DMA,
+    HEAP_REGION_COUNT
+  };
+
+  /**
+   * @brief Point-in-time statistics for one heap region.
+   */
+  struct HeapCapsStats {
+    uint32_t freeBytes;     ///< Currently free bytes
+    uint32_t largestBlock;  ///< Largest contiguous free block
+    uint32_t minFreeBytes;  ///< Low-water mark since boot
+  };
+
+  #if defined(ARDUINO_ARCH_ESP32)
+  /**
+   * @brief Returns the heap_caps capability mask used for a region (ESP32 only).
+   */
+  inline uint32_t heapRegionCaps(HeapRegion region) noexcept {
+    switch (region) {
+      case HEAP_INTERNAL: return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+      case HEAP_PSRAM:    return MALLOC_CAP_SPIRAM;
+      case HEAP_DMA:      return MALLOC_CAP_DMA;
+      default:            return MALLOC_CAP_DEFAULT;
+    }
+  }
+  #endif
+
+  /**
+   * @brief Returns free / largest-block / low-water statistics for one heap region.
+   *
+   * @param region The region to query
+   * @return The region statistics (all zero for a region the device does not have)
+   *
+   * @note On non-ESP32 platforms HEAP_DEFAULT and HEAP_INTERNAL both report freeRam();
+   *       HEAP_PSRAM and HEAP_DMA report zero.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::HeapCapsStats psram = HubMemoryUtils::capsStats(HubMemoryUtils::HEAP_PSRAM);
+   * Serial.printf("PSRAM free: %u (largest %u)\n", psram.freeBytes, psram.largestBlock);
+   * @endcode
+   */
+  inline HeapCapsStats capsStats(HeapRegion region) noexcept {
+    HeapCapsStats stats = {0, 0, 0};
+    #if defined(ARDUINO_ARCH_ESP32)
+      const uint32_t caps = heapRegionCaps(region);
+      stats.freeBytes = heap_caps_get_free_size(caps);
+      stats.largestBlock = heap_caps_get_largest_free_block(caps);
+      stats.minFreeBytes = heap_caps_get_minimum_free_size(caps);
+    #else
+      if (region == HEAP_DEFAULT || region == HEAP_INTERNAL) {
+        const uint32_t free = freeRam();
+        stats.freeBytes = free;
+        stats.largestBlock = free;
+        stats.minFreeBytes = free;
+      }
+    #endif
+    return stats;
+  }
+
+  /**
+   * @brief Fragmentation of a region as a percentage: 0 when all free memory is one block.
+   *
+   * @return 100 * (1 - largestBlock / freeBytes), or 0.0 when nothing is free
+   */
+  inline float fragmentationPercent(const HeapCapsStats& stats) noexcept {
+    if (stats.freeBytes == 0) return 0.0f;
+    return 100.0f * (1.0f - static_cast<float>(stats.largestBlock) / static_cast<float>(stats.freeBytes));
+  }
+
+  // ---------------------------------------------------------------------------
+  // Periodic sampler
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief One timestamped snapshot of every heap region (52 bytes).
+   */
+  struct HeapSample {
+    uint32_t timestampMs;
+    HeapCapsStats regions[HEAP_REGION_COUNT];
+  };
+
+  /**
+   * @brief Records a fixed-size ring of timestamped heap snapshots for long-uptime trend analysis.
+   *
+   * Call tick() from loop() (or any periodic task); a sample is taken once every interval.
+   * When the ring is full the oldest sample is overwritten, so the ring always covers the last
+   * Capacity * interval of uptime. No heap allocation: the ring lives inside the object
+   * (Capacity * 52 bytes).
+   *
+   * @tparam Capacity Number of samples kept
+   *
+   * @note Not synchronised: sample and read from the same task.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::HeapSampler<48> heapHistory(30UL * 60 * 1000);  // 24h at 30 min
+   *
+   * void loop() {
+   *     heapHistory.tick();
+   *     if (heapHistory.freeSlopePerHour(HubMemoryUtils::HEAP_INTERNAL) < -1024.0f) {
+   *         Serial.println("Internal heap is leaking > 1KB/hour");
+   *     }
+   * }
+   * @endcode
+   */
+  template <size_t Capacity>
+  class HeapSampler {
+    static_assert(Capacity > 0, "HeapSampler needs at least one slot");
+
+    public:
+      explicit HeapSampler(uint32_t intervalMs = 60000) noexcept
+        : intervalMs_(intervalMs), lastSampleMs_(0), head_(0), count_(0) {}
+
+      void setInterval(uint32_t intervalMs) noexcept { intervalMs_ = intervalMs; }
+      uint32_t interval() const noexcept { return intervalMs_; }
+
+      /**
+       * @brief Takes a sample if the interval has elapsed (or none has been taken yet).
+       * @return true when a sample was recorded
+       */
+      bool tick() noexcept {
+        const uint32_t now = millis();
+        if (count_ != 0 && (now - lastSampleMs_) < intervalMs_) {
+          return false;
+        }
+        sampleAt(now);
+        return true;
+      }
+
+      /**
+       * @brief Records a sample immediately, regardless of the interval.
+       */
+      const HeapSample& sample() noexcept {
+        return sampleAt(millis());
+      }
+
+      size_t size() const noexcept { return count_; }
+      static constexpr size_t capacity() noexcept { return Capacity; }
+      bool empty() const noexcept { return count_ == 0; }
+      void clear() noexcept { head_ = 0; count_ = 0; }
+
+      /**
+       * @brief Returns sample i, oldest first (i < size()).
+       */
+      const HeapSample& at(size_t i) const noexcept {
+        return ring_[(head_ + Capacity - count_ + i) % Capacity];
+      }
+      const HeapSample& oldest() const noexcept { return at(0); }
+      const HeapSample& latest() const noexcept { return at(count_ - 1); }
+
+      /**
+       * @brief Least-squares slope of free bytes over the ring, in bytes per hour.
+       * @return Negative when the region is shrinking; 0.0 with fewer than two samples
+       */
+      float freeSlopePerHour(HeapRegion region) const noexcept {
+        return slopePerHour(region, false);
+      }
+
+      /**
+       * @brief Least-squares slope of the largest free block over the ring, in bytes per hour.
+       *
+       * A falling largest block with a flat freeSlopePerHour() means fragmentation is worsening.
+       */
+      float largestBlockSlopePerHour(HeapRegion region) const noexcept {
+        return slopePerHour(region, true);
+      }
+
+      /**
+       * @brief Change in fragmentationPercent() between the oldest and latest sample.
+       */
+      float fragmentationTrend(HeapRegion region) const noexcept {
+        if (count_ < 2) return 0.0f;
+        return fragmentationPercent(latest().regions[region]) - fragmentationPercent(oldest().regions[region]);
+      }
+
+      /**
+       * @brief Writes the ring as CSV, oldest first, one line per sample.
+       *
+       * Columns: ms, then free/largest/min_free for default, internal, psram and dma.
+       */
+      void printTo(Print& out) const {
+        static const char* const names[HEAP_REGION_COUNT] = {"default", "internal", "psram", "dma"};
+        out.print("ms");
+        for (uint8_t r = 0; r < HEAP_REGION_COUNT; r++) {
+          out.print(','); out.print(names[r]); out.print("_free");
+          out.print(','); out.print(names[r]); out.print("_largest");
+          out.print(','); out.print(names[r]); out.print("_min_free");
+        }
+        out.println();
+        for (size_t i = 0; i < count_; i++) {
+          const HeapSample& s = at(i);
+          out.print(s.timestampMs);
+          for (uint8_t r = 0; r < HEAP_REGION_COUNT; r++) {
+            out.print(','); out.print(s.regions[r].freeBytes);
+            out.print(','); out.print(s.regions[r].largestBlock);
+            out.print(','); out.print(s.regions[r].minFreeBytes);
+          }
+          out.println();
+        }
+      }
+
+    private:
+      const HeapSample& sampleAt(uint32_t now) noexcept {
+        HeapSample& s = ring_[head_];
+        s.timestampMs = now;
+        for (uint8_t r = 0; r < HEAP_REGION_COUNT; r++) {
+          s.regions[r] = capsStats(static_cast<HeapRegion>(r));
+        }
+        head_ = (head_ + 1) % Capacity;
+        if (count_ < Capacity) count_++;
+        lastSampleMs_ = now;
+        return s;
+      }
+
+      float slopePerHour(HeapRegion region, bool largest) const noexcept {
+        if (count_ < 2) return 0.0f;
+        // Hours since the oldest sample (unsigned subtraction survives millis() wrap)
+        const uint32_t t0 = oldest().timestampMs;
+        float sumX = 0.0f, sumY = 0.0f, sumXY = 0.0f, sumXX = 0.0f;
+        for (size_t i = 0; i < count_; i++) {
+          const HeapSample& s = at(i);
+          const float x = static_cast<float>(s.timestampMs - t0) / 3600000.0f;
+          const float y = static_cast<float>(largest ? s.regions[region].largestBlock : s.regions[region].freeBytes);
+          sumX += x; sumY += y; sumXY += x * y; sumXX += x * x;
+        }
+        const float n = static_cast<float>(count_);
+        const float denom = n * sumXX - sumX * sumX;
+        if (denom <= 0.0f) return 0.0f;
+        return (n * sumXY - sumX * sumY) / denom;
+      }
+
+      uint32_t intervalMs_;
+      uint32_t lastSampleMs_;
+      size_t head_;   // Next slot to write
+      size_t count_;
+      HeapSample ring_[Capacity];
+  };
+
+  // ---------------------------------------------------------------------------
+  // Allocation attribution
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Accumulates the heap retained by code run inside HeapTagScope blocks.
+   *
+   * Declare one per module you want to attribute (e.g. the SerialProxy buffer, split() results)
+   * and wrap the allocating code in a HeapTagScope. Each scope adds the bytes it left allocated
+   * to retainedBytes.
+   *
+   * By default a scope measures the drop in free heap between entry and exit, which is cheap and
+   * works everywhere but also counts allocations made concurrently by other tasks. When the
+   * ESP-IDF standalone heap tracer is enabled (CONFIG_HEAP_TRACING_STANDALONE) and the tag was
+   * created with trace = true, the scope instead runs the tracer in leak mode and sums the
+   * allocations still outstanding at exit. That ignores the scope's transient allocations and
+   * other tasks' frees, but the tracer records allocations from every task, so concurrent
+   * allocations still outstanding at exit are attributed to the tag too. See heapTraceBegin().
+   */
+  struct HeapTag {
+    const char* name;
+    int32_t retainedBytes;  ///< Net bytes left allocated by all scopes so far
+    int32_t peakBytes;      ///< Highest retainedBytes seen
+    uint32_t scopes;        ///< Number of completed scopes
+    bool trace;             ///< Use the heap tracer when available
+
+    explicit HeapTag(const char* tagName, bool useTrace = false) noexcept
+      : name(tagName), retainedBytes(0), peakBytes(0), scopes(0), trace(useTrace) {}
+
+    void reset() noexcept { retainedBytes = 0; peakBytes = 0; scopes = 0; }
+  };
+
+  namespace detail {
+    // Set once heapTraceBegin() succeeds; cleared while a traced scope owns the tracer
+    inline bool& heapTraceReady() noexcept { static bool ready = false; return ready; }
+
+    #if HUB_MEMORY_HAS_HEAP_TRACE
+    inline portMUX_TYPE& heapTraceMux() noexcept { static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; return mux; }
+    inline bool& heapTraceBusy() noexcept { static bool busy = false; return busy; }
+
+    // Claims the tracer for one scope; the check-and-set is atomic across tasks and cores
+    inline bool heapTraceAcquire() noexcept {
+      portENTER_CRITICAL(&heapTraceMux());
+      const bool claimed = !heapTraceBusy();
+      heapTraceBusy() = true;
+      portEXIT_CRITICAL(&heapTraceMux());
+      return claimed;
+    }
+
+    inline void heapTraceRelease() noexcept {
+      portENTER_CRITICAL(&heapTraceMux());
+      heapTraceBusy() = false;
+      portEXIT_CRITICAL(&heapTraceMux());
+    }
+    #endif
+  }
+
+  /**
+   * @brief Hands the ESP-IDF heap tracer its record buffer so traced HeapTags can use it.
+   *
+   * @param records Static buffer of heap_trace_record_t (at least as many entries as
+   *                allocations a single traced scope may leave outstanding)
+   * @param count   Number of entries in records
+   * @return true if heap tracing is available and was initialised
+   *
+   * @note Requires CONFIG_HEAP_TRACING_STANDALONE in sdkconfig; otherwise returns false and
+   *       traced tags fall back to free-heap deltas. The parameter type is void* so callers
+   *       compile on every platform.
+   *
+   * Example:
+   * @code
+   * #include <esp_heap_trace.h>
+   * static heap_trace_record_t traceRecords[64];
+   * HubMemoryUtils::heapTraceBegin(traceRecords, 64);
+   * @endcode
+   */
+  inline bool heapTraceBegin(void* records, size_t count) noexcept {
+    #if HUB_MEMORY_HAS_HEAP_TRACE
+      if (records == nullptr || count == 0) return false;
+      if (heap_trace_init_standalone(static_cast<heap_trace_record_t*>(records), count) != ESP_OK) return false;
+      detail::heapTraceReady() = true;
+      return true;
+    #else
+      (void)records; (void)count;
+      return false;
+    #endif
+  }
+
+  /**
+   * @brief True when heapTraceBegin() succeeded and traced scopes will use the tracer.
+   */
+  inline bool heapTraceAvailable() noexcept {
+    return detail::heapTraceReady();
+  }
+
+  /**
+   * @brief RAII scope attributing the heap retained by its body to a HeapTag.
+   *
+   * Only one traced scope owns the tracer at a time; a traced scope entered while another is
+   * active (nested, or on another task) falls back to the free-heap delta.
+   *
+   * Example:
+   * @code
+   * static HubMemoryUtils::HeapTag splitTag("split");
+   *
+   * std::vector<String> parts;
+   * {
+   *     HubMemoryUtils::HeapTagScope scope(splitTag);
+   *     parts = HubStringUtils::split(line, ',');
+   * }
+   * Serial.printf("%s retains %d bytes\n", splitTag.name, splitTag.retainedBytes);
+   * @endcode
+   */
+  class HeapTagScope {
+    public:
+      explicit HeapTagScope(HeapTag& tag) noexcept
+        : tag_(tag), startFree_(freeRam()), traced_(false) {
+        #if HUB_MEMORY_HAS_HEAP_TRACE
+          if (tag.trace && detail::heapTraceReady() && detail::heapTraceAcquire()) {
+            traced_ = heap_trace_start(HEAP_TRACE_LEAKS) == ESP_OK;
+            if (!traced_) detail::heapTraceRelease();
+          }
+        #endif
+      }
+
+      ~HeapTagScope() {
+        int32_t retained = static_cast<int32_t>(startFree_) - static_cast<int32_t>(freeRam());
+        #if HUB_MEMORY_HAS_HEAP_TRACE
+          if (traced_) {
+            heap_trace_stop();
+            retained = 0;
+            const size_t n = heap_trace_get_count();
+            for (size_t i = 0; i < n; i++) {
+              heap_trace_record_t record;
+              if (heap_trace_get(i, &record) == ESP_OK && record.address != nullptr) {
+                retained += static_cast<int32_t>(record.size);
+              }
+            }
+            detail::heapTraceRelease();
+          }
+        #endif
+        tag_.retainedBytes += retained;
+        if (tag_.retainedBytes > tag_.peakBytes) tag_.peakBytes = tag_.retainedBytes;
+        tag_.scopes++;
+      }
+
+      HeapTagScope(const HeapTagScope&) = delete;
+      HeapTagScope& operator=(const HeapTagScope&) = delete;
+
+    private:
+      HeapTag& tag_;
+      size_t startFree_;
+      bool traced_;
+  };
+  // ---------------------------------------------------------------------------
+  // Region-aware allocation, fixed-block pool and frame arena
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Allocates raw memory from a heap region.
+   *
+   * @param size     Bytes to allocate
+   * @param region   Region to allocate from (see HeapRegion)
+   * @param fallback When true, a failed HEAP_PSRAM allocation (no PSRAM fitted, or full)
+   *                 retries on the default heap
+   * @return The allocation, or nullptr on failure. Release with regionFree().
+   *
+   * @note On non-ESP32 platforms the region is ignored and malloc() is used.
+   */
+  inline void* regionAlloc(size_t size, HeapRegion region = HEAP_DEFAULT, bool fallback = true) noexcept {
+    #if defined(ARDUINO_ARCH_ESP32)
+      void* p = heap_caps_malloc(size, heapRegionCaps(region));
+      if (p == nullptr && fallback && region == HEAP_PSRAM) {
+        p = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+      }
+      return p;
+    #else
+      (void)region; (void)fallback;
+      return malloc(size);
+    #endif
+  }
+
+  /**
+   * @brief Releases memory obtained from regionAlloc().
+   */
+  inline void regionFree(void* ptr) noexcept {
+    #if defined(ARDUINO_ARCH_ESP32)
+      heap_caps_free(ptr);
+    #else
+      free(ptr);
+    #endif
+  }
+
+  /// Alignment of every BlockPool block and the default FrameArena alignment
+  static constexpr size_t kMaxAlign = alignof(std::max_align_t);
+
+  /**
+   * @brief Fixed-size block pool carved from a single up-front allocation.
+   *
+   * All blocks are allocated once in the constructor, so allocate()/deallocate() never touch
+   * the general heap and can never fragment it. Use it for objects that are created and
+   * destroyed repeatedly at runtime (list / map nodes, message structs, std::function
+   * captures that exceed the small-buffer size).
+   *
+   * allocate() returns nullptr when the pool is exhausted. Blocks are aligned to kMaxAlign.
+   *
+   * @note On ESP32 allocate()/deallocate() are guarded by a spinlock, so tasks on both cores
+   *       may share one pool.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::BlockPool msgPool(sizeof(Message), 32, HubMemoryUtils::HEAP_PSRAM);
+   *
+   * Message* m = new (msgPool.allocate()) Message();
+   * // ...
+   * m->~Message();
+   * msgPool.deallocate(m);
+   * @endcode
+   */
+  class BlockPool {
+    public:
+      BlockPool(size_t blockSize, size_t blockCount, HeapRegion region = HEAP_DEFAULT) noexcept
+        : raw_(nullptr), slab_(nullptr), free_(nullptr),
+          blockSize_(roundUp(blockSize < sizeof(FreeNode) ? sizeof(FreeNode) : blockSize)),
+          count_(blockCount), available_(0), highWater_(0), failures_(0) {
+        if (count_ == 0) return;
+        raw_ = regionAlloc(blockSize_ * count_ + kMaxAlign - 1, region);
+        if (raw_ == nullptr) {
+          count_ = 0;
+          return;
+        }
+        slab_ = reinterpret_cast<uint8_t*>(roundUp(reinterpret_cast<uintptr_t>(raw_)));
+        // Thread the free list through the blocks, lowest address first
+        for (size_t i = count_; i > 0; i--) {
+          FreeNode* node = reinterpret_cast<FreeNode*>(slab_ + (i - 1) * blockSize_);
+          node->next = free_;
+          free_ = node;
+        }
+        available_ = count_;
+      }
+
+      ~BlockPool() { regionFree(raw_); }
+
+      BlockPool(const BlockPool&) = delete;
+      BlockPool& operator=(const BlockPool&) = delete;
+
+      /** @brief True if the backing allocation succeeded */
+      bool valid() const noexcept { return slab_ != nullptr; }
+
+      /**
+       * @brief Takes one block from the pool.
+       * @return A block of blockSize() bytes, or nullptr when the pool is exhausted
+       */
+      void* allocate() noexcept {
+        lock();
+        FreeNode* node = free_;
+        if (node != nullptr) {
+          free_ = node->next;
+          available_--;
+          if (count_ - available_ > highWater_) highWater_ = count_ - available_;
+        } else {
+          failures_++;
+        }
+        unlock();
+        return node;
+      }
+
+      /**
+       * @brief Returns a block to the pool. nullptr and pointers the pool does not own are ignored.
+       */
+      void deallocate(void* ptr) noexcept {
+        if (!owns(ptr)) return;
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        lock();
+        node->next = free_;
+        free_ = node;
+        available_++;
+        unlock();
+      }
+
+      /** @brief True if ptr points at the start of one of this pool's blocks */
+      bool owns(const void* ptr) const noexcept {
+        const uint8_t* p = static_cast<const uint8_t*>(ptr);
+        return slab_ != nullptr && p >= slab_ && p < slab_ + blockSize_ * count_ &&
+               (static_cast<size_t>(p - slab_) % blockSize_) == 0;
+      }
+
+      size_t blockSize() const noexcept { return blockSize_; }
+      size_t capacity() const noexcept { return count_; }
+      size_t available() const noexcept { return available_; }
+      size_t inUse() const noexcept { return count_ - available_; }
+      size_t highWater() const noexcept { return highWater_; }  ///< Most blocks in use at once
+      uint32_t failures() const noexcept { return failures_; }  ///< allocate() calls that found the pool empty
+
+    private:
+      struct FreeNode { FreeNode* next; };
+
+      static constexpr size_t roundUp(size_t n) noexcept { return (n + kMaxAlign - 1) & ~(kMaxAlign - 1); }
+
+      #if defined(ARDUINO_ARCH_ESP32)
+      void lock() noexcept { portENTER_CRITICAL(&mux_); }
+      void unlock() noexcept { portEXIT_CRITICAL(&mux_); }
+      portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+      #else
+      void lock() noexcept {}
+      void unlock() noexcept {}
+      #endif
+
+      void* raw_;        // As returned by regionAlloc()
+      uint8_t* slab_;    // raw_ aligned up to kMaxAlign
+      FreeNode* free_;
+      size_t blockSize_;
+      size_t count_;
+      size_t available_;
+      size_t highWater_;
+      uint32_t failures_;
+  };
+
+  /**
+   * @brief Resettable bump allocator for per-frame (per-loop, per-request) scratch memory.
+   *
+   * allocate() just advances an offset into one up-front buffer; nothing is freed individually.
+   * Call reset() at the end of the frame to reclaim everything at once, or mark()/rewind() to
+   * release a nested group of allocations. Because the buffer is never returned to the heap
+   * between frames, repeated temporary allocations cannot fragment it.
+   *
+   * @note reset() and rewind() do not run destructors; only place trivially destructible data,
+   *       or objects you destroy yourself, in an arena.
+   * @note Not synchronised: use one arena per task.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::FrameArena frame(4096);
+   *
+   * void loop() {
+   *     char* scratch = static_cast<char*>(frame.allocate(256));
+   *     // ... build a reply in scratch ...
+   *     frame.reset();
+   * }
+   * @endcode
+   */
+  class FrameArena {
+    public:
+      typedef size_t Marker;
+
+      explicit FrameArena(size_t capacity, HeapRegion region = HEAP_DEFAULT) noexcept
+        : base_(nullptr), capacity_(capacity), offset_(0), highWater_(0), failures_(0) {
+        if (capacity_ != 0) base_ = static_cast<uint8_t*>(regionAlloc(capacity_, region));
+        if (base_ == nullptr) capacity_ = 0;
+      }
+
+      ~FrameArena() { regionFree(base_); }
+
+      FrameArena(const FrameArena&) = delete;
+      FrameArena& operator=(const FrameArena&) = delete;
+
+      /** @brief True if the backing allocation succeeded */
+      bool valid() const noexcept { return base_ != nullptr; }
+
+      /**
+       * @brief Carves size bytes aligned to align (a power of two) from the arena.
+       * @return The allocation, or nullptr if the arena does not have room
+       */
+      void* allocate(size_t size, size_t align = kMaxAlign) noexcept {
+        const uintptr_t start = reinterpret_cast<uintptr_t>(base_) + offset_;
+        const size_t pad = static_cast<size_t>((align - (start & (align - 1))) & (align - 1));
+        // Written as two subtractions so a huge size or pad cannot wrap past the check
+        if (base_ == nullptr || size > capacity_ - offset_ || pad > capacity_ - offset_ - size) {
+          failures_++;
+          return nullptr;
+        }
+        void* p = base_ + offset_ + pad;
+        offset_ += pad + size;
+        if (offset_ > highWater_) highWater_ = offset_;
+        return p;
+      }
+
+      /** @brief Releases everything allocated since construction or the last reset() */
+      void reset() noexcept { offset_ = 0; }
+
+      /** @brief Current position, for a later rewind() */
+      Marker mark() const noexcept { return offset_; }
+
+      /** @brief Releases everything allocated since mark() returned m */
+      void rewind(Marker m) noexcept { if (m <= offset_) offset_ = m; }
+
+      /** @brief True if ptr lies inside the arena buffer */
+      bool owns(const void* ptr) const noexcept {
+        const uint8_t* p = static_cast<const uint8_t*>(ptr);
+        return base_ != nullptr && p >= base_ && p < base_ + capacity_;
+      }
+
+      size_t used() const noexcept { return offset_; }
+      size_t capacity() const noexcept { return capacity_; }
+      size_t remaining() const noexcept { return capacity_ - offset_; }
+      size_t highWater() const noexcept { return highWater_; }  ///< Largest used() seen
+      uint32_t failures() const noexcept { return failures_; }  ///< allocate() calls that did not fit
+
+    private:
+      uint8_t* base_;
+      size_t capacity_;
+      size_t offset_;
+      size_t highWater_;
+      uint32_t failures_;
+  };
+
+  namespace detail {
+    /** @brief What operator new does on failure: throws std::bad_alloc, or aborts when exceptions are off */
+    [[noreturn]] inline void allocationTooLarge() {
+      #if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+      throw std::bad_alloc();
+      #else
+      abort();
+      #endif
+    }
+  } // namespace detail
+
+  /**
+   * @brief Standard-library allocator drawing single-element allocations from a BlockPool.
+   *
+   * Suited to node-based containers (std::list, std::map, std::set) whose nodes fit in one
+   * block. Requests larger than blockSize(), or made while the pool is exhausted, fall back
+   * to ::operator new, so the container keeps working when the pool runs dry.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::BlockPool nodePool(48, 64);
+   * std::list<Event, HubMemoryUtils::PoolAllocator<Event>> events{HubMemoryUtils::PoolAllocator<Event>(nodePool)};
+   * @endcode
+   */
+  template <typename T>
+  class PoolAllocator {
+    public:
+      typedef T value_type;
+
+      explicit PoolAllocator(BlockPool& pool) noexcept : pool_(&pool) {}
+      template <typename U>
+      PoolAllocator(const PoolAllocator<U>& other) noexcept : pool_(other.pool()) {}
+
+      T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) detail::allocationTooLarge();
+        const size_t bytes = n * sizeof(T);
+        if (bytes <= pool_->blockSize() && alignof(T) <= kMaxAlign) {
+          void* p = pool_->allocate();
+          if (p != nullptr) return static_cast<T*>(p);
+        }
+        return static_cast<T*>(::operator new(bytes));
+      }
+
+      void deallocate(T* ptr, size_t) noexcept {
+        if (pool_->owns(ptr)) {
+          pool_->deallocate(ptr);
+        } else {
+          ::operator delete(ptr);
+        }
+      }
+
+      BlockPool* pool() const noexcept { return pool_; }
+
+    private:
+      BlockPool* pool_;
+  };
+
+  template <typename T, typename U>
+  inline bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept { return a.pool() == b.pool(); }
+  template <typename T, typename U>
+  inline bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept { return a.pool() != b.pool(); }
+
+  /**
+   * @brief Standard-library allocator placing container storage in a FrameArena.
+   *
+   * deallocate() is a no-op for arena memory (it is reclaimed by reset()); when the arena is
+   * full, allocations fall back to ::operator new and are freed normally. Reserve up front
+   * where possible: a growing std::vector leaves its previous buffers in the arena until reset().
+   *
+   * @note The container must be destroyed (or cleared) before the arena is reset.
+   *
+   * Example:
+   * @code
+   * HubMemoryUtils::FrameArena frame(2048);
+   * typedef HubMemoryUtils::ArenaAllocator<String> FrameAlloc;
+   *
+   * void handleLine(const String& line) {
+   *     {
+   *         std::vector<String, FrameAlloc> fields{FrameAlloc(frame)};
+   *         HubStringUtils::splitInto(line, ',', fields);
+   *         // ...
+   *     }
+   *     frame.reset();
+   * }
+   * @endcode
+   */
+  template <typename T>
+  class ArenaAllocator {
+    public:
+      typedef T value_type;
+
+      explicit ArenaAllocator(FrameArena& arena) noexcept : arena_(&arena) {}
+      template <typename U>
+      ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+      T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) detail::allocationTooLarge();
+        void* p = arena_->allocate(n * sizeof(T), alignof(T));
+        if (p != nullptr) return static_cast<T*>(p);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+      }
+
+      void deallocate(T* ptr, size_t) noexcept {
+        if (!arena_->owns(ptr)) ::operator delete(ptr);
+      }
+
+      FrameArena* arena() const noexcept { return arena_; }
+
+    private:
+      FrameArena* arena_;
+  };
+
+  template <typename T, typename U>
+  inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.arena() == b.arena(); }
+  template <typename T, typename U>
+  inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.arena() != b.arena(); }
+
 } // namespace HubMemoryUtils
 
 // Convenience using declarations for backward compatibility and ease of use
@@ -164,5 +955,7 @@ using HubMemoryUtils::minFreeRam;
 using HubMemoryUtils::largestFreeBlock;
 using HubMemoryUtils::totalHeap;
 using HubMemoryUtils::heapUsagePercent;
+using HubMemoryUtils::capsStats;
+using HubMemoryUtils::fragmentationPercent;
 
 #endif // HUB_MEMORY_UTILS_H
@@ -8,7 +8,14 @@
 #include <Wire.h>
 #include <cstring>
 #include <new>
+#include <atomic>
 #include "definitions.h"
+#include "delegate.hpp"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
 // SerialProxy
 // -------------
@@ -18,72 +25,297 @@
 // Key characteristics:
 //  - Ring buffer with overwrite on wrap (always contains most recent data up to capacity).
 //  - Memory allocation failure resilience (silent no-op buffering if alloc fails).
+//  - Optional caller-supplied buffer (pool / arena / PSRAM) instead of a heap allocation.
 //  - Reduced duplicated write logic via helper functions.
 //  - Additional convenience overloads for String and C strings.
+//  - Writes copy in at most two memcpy chunks (no per-byte modulo).
 //  - tail() scans backward for newline-delimited lines; returns what is available.
+//  - tail(Print&) / tail(sink) stream the same bytes over the one or two contiguous spans without allocating.
+//  - Mirror modes: SYNC writes to Serial inline; ASYNC only appends to the ring and service()
+//    (or the ESP32 mirror task) drains the unsent region as Serial TX space frees up, never blocking.
+//    Bytes overwritten before they were mirrored are counted in droppedBytes().
+//  - Concurrent mode: many tasks/ISRs may write at once; each write(buffer, size) lands contiguously.
+//    Space is reserved with a lock-free CAS on one packed word (no mutex, so ISR-safe) and the data is
+//    published to readers once no write is in flight.
 //  - Provides size(), capacity(), wrapped() introspection helpers.
 //  - Non-copyable (avoids double free), movable.
 
+enum class SerialMirrorMode : uint8_t {
+    SYNC,   // Serial.write() inside every write() (default)
+    ASYNC   // write() only buffers; service()/mirror task drains to Serial
+};
+
 class SerialProxy : public CachingPrinter {
+    public:
+        // Receives one contiguous span of tail() output per call
+        typedef Delegate<void(const uint8_t*, size_t)> TailSink;
+
     private:
         size_t buf_size_;          // Total capacity
-        size_t head_;              // Next write index
-        bool full_;                // Whether buffer has wrapped at least once
+        size_t head_;              // Next write index (single-writer mode)
+        std::atomic<bool> full_;   // Whether buffer has wrapped at least once
         byte* buf_;                // Ring buffer storage
+        bool owns_buf_;            // false when buf_ was supplied by the caller (pool, arena, static)
+        uint32_t wrap_;            // Largest multiple of buf_size_ <= 2^24; positions count modulo this
+        std::atomic<uint32_t> written_; // Total bytes appended (mod wrap_), so written_ % buf_size_ == head_
+        uint32_t mirrored_;        // ASYNC: position of the next byte to send (mod wrap_)
+        uint32_t dropped_;         // ASYNC: bytes overwritten before they were sent
+        SerialMirrorMode mirror_mode_;
+        bool concurrent_;          // Multi-producer mode
+        std::atomic<uint32_t> reserve_; // Concurrent: [31:24] writes in flight, [23:0] next reserved position
+
+        static const uint32_t kPositionMask = 0x00FFFFFFUL;
+        static const uint32_t kInFlightOne = 0x01000000UL;
+#if defined(ARDUINO_ARCH_ESP32)
+        volatile TaskHandle_t mirror_task_;
+        volatile bool mirror_task_stop_;
+        TickType_t mirror_period_;
+#endif
+
+        inline uint32_t distance(uint32_t to, uint32_t from) const {
+            return to >= from ? to - from : to + wrap_ - from;
+        }
+
+        inline uint32_t advance(uint32_t pos, size_t len) const {
+            uint32_t next = pos + static_cast<uint32_t>(len % wrap_);
+            return next >= wrap_ ? next - wrap_ : next;
+        }
+
+        inline void mirror(const uint8_t* data, size_t len) {
+            if (mirror_mode_ != SerialMirrorMode::SYNC) return;
+#if defined(ARDUINO_ARCH_ESP32)
+            if (xPortInIsrContext()) return; // Serial.write() may take a mutex; ISR output stays in the ring
+#endif
+            if (Serial) { Serial.write(data, len); }
+        }
+
+        inline size_t currentHead() const {
+            return concurrent_ ? written_.load(std::memory_order_acquire) % buf_size_ : head_;
+        }
+
+        // Multi-producer append: reserve [pos, pos + len) atomically, copy, then publish when no write is in flight
+        void appendConcurrent(const uint8_t* data, size_t len) {
+            uint32_t state = reserve_.load(std::memory_order_relaxed);
+            uint32_t pos;
+            do {
+                pos = state & kPositionMask;
+            } while (!reserve_.compare_exchange_weak(state, (state & ~kPositionMask) + kInFlightOne + advance(pos, len),
+                                                     std::memory_order_acq_rel, std::memory_order_relaxed));
+
+            size_t copy = len;
+            uint32_t start = pos;
+            if (len > buf_size_) {
+                start = advance(pos, len - buf_size_);
+                data += len - buf_size_;
+                copy = buf_size_;
+            }
+            size_t index = start % buf_size_;
+            size_t first = std::min(copy, buf_size_ - index);
+            memcpy(buf_ + index, data, first);
+            if (first < copy) {
+                memcpy(buf_, data + first, copy - first);
+            }
+            if (!full_.load(std::memory_order_relaxed) && static_cast<size_t>(pos) + len >= buf_size_) {
+                full_.store(true, std::memory_order_relaxed);
+            }
+
+            state = reserve_.fetch_sub(kInFlightOne, std::memory_order_acq_rel) - kInFlightOne;
+            if ((state & ~kPositionMask) == 0) {
+                publish(state & kPositionMask);
+            }
+        }
+
+        // Move written_ forward to pos (never backward if publishers race)
+        void publish(uint32_t pos) {
+            uint32_t current = written_.load(std::memory_order_relaxed);
+            while (pos != current && distance(pos, current) < wrap_ / 2 &&
+                   !written_.compare_exchange_weak(current, pos, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
 
         inline void appendByte(uint8_t c) {
             if (!buf_) return; // Allocation failed safeguard
+            if (concurrent_) { appendConcurrent(&c, 1); return; }
             buf_[head_] = c;
-            head_ = (head_ + 1) % buf_size_;
-            if (head_ == 0) { full_ = true; }
+            if (++head_ == buf_size_) { head_ = 0; full_ = true; }
+            written_.store(advance(written_.load(std::memory_order_relaxed), 1), std::memory_order_release);
         }
 
         inline void appendBuffer(const uint8_t* data, size_t len) {
             if (!buf_ || !data || len == 0) return;
-            for (size_t i = 0; i < len; ++i) {
-                appendByte(data[i]);
+            if (concurrent_) { appendConcurrent(data, len); return; }
+            uint32_t written = advance(written_.load(std::memory_order_relaxed), len);
+            size_t copy = len;
+            if (len > buf_size_) {
+                // Only the newest buf_size_ bytes survive; skip the rest but keep positions consistent
+                size_t skip = len - buf_size_;
+                head_ = (head_ + skip) % buf_size_;
+                data += skip;
+                copy = buf_size_;
+            }
+            size_t first = std::min(copy, buf_size_ - head_);
+            memcpy(buf_ + head_, data, first);
+            if (first < copy) {
+                memcpy(buf_, data + first, copy - first);
+            }
+            head_ += copy;
+            if (head_ >= buf_size_) { head_ -= buf_size_; full_ = true; }
+            written_.store(written, std::memory_order_release);
+        }
+
+        // Send up to max_bytes of the unsent region; non-blocking sends only what Serial can take without waiting
+        size_t drain(size_t max_bytes, bool blocking) {
+            if (!buf_ || !Serial) return 0;
+            uint32_t written = written_.load(std::memory_order_acquire);
+            uint32_t unsent = distance(written, mirrored_);
+            if (unsent > buf_size_) {
+                dropped_ += unsent - buf_size_;
+                mirrored_ = written >= buf_size_ ? written - buf_size_ : written + wrap_ - buf_size_;
+                unsent = buf_size_;
+            }
+            size_t count = std::min<size_t>(unsent, max_bytes);
+            if (!blocking) {
+                int room = Serial.availableForWrite();
+                count = std::min<size_t>(count, room > 0 ? static_cast<size_t>(room) : 0);
+            }
+            if (count == 0) return 0;
+
+            size_t start = mirrored_ % buf_size_;
+            size_t first = std::min(count, buf_size_ - start);
+            Serial.write(buf_ + start, first);
+            if (first < count) {
+                Serial.write(buf_, count - first);
+            }
+            mirrored_ = advance(mirrored_, count);
+            return count;
+        }
+
+#if defined(ARDUINO_ARCH_ESP32)
+        static void mirrorTaskEntry(void* arg) {
+            SerialProxy* self = static_cast<SerialProxy*>(arg);
+            while (!self->mirror_task_stop_) {
+                self->service();
+                vTaskDelay(self->mirror_period_);
+            }
+            self->mirror_task_ = nullptr;
+            vTaskDelete(nullptr);
+        }
+#endif
+
+        void resetMirrorState() {
+            wrap_ = static_cast<uint32_t>(buf_size_ * ((kPositionMask + 1) / buf_size_));
+            written_.store(static_cast<uint32_t>(head_));
+            reserve_.store(static_cast<uint32_t>(head_));
+            concurrent_ = false;
+            mirrored_ = static_cast<uint32_t>(head_);
+            dropped_ = 0;
+            mirror_mode_ = SerialMirrorMode::SYNC;
+#if defined(ARDUINO_ARCH_ESP32)
+            mirror_task_ = nullptr;
+            mirror_task_stop_ = false;
+            mirror_period_ = 1;
+#endif
+        }
+
+        void takeFrom(SerialProxy& other) {
+            other.stopMirrorTask();
+            buf_size_ = other.buf_size_; head_ = other.head_; full_.store(other.full_.load()); buf_ = other.buf_;
+            owns_buf_ = other.owns_buf_;
+            wrap_ = other.wrap_; written_.store(other.written_.load()); mirrored_ = other.mirrored_;
+            dropped_ = other.dropped_; mirror_mode_ = other.mirror_mode_;
+            concurrent_ = other.concurrent_; reserve_.store(other.reserve_.load());
+            other.buf_ = nullptr; other.buf_size_ = 1; other.head_ = 0; other.full_ = false;
+            other.resetMirrorState();
+        }
+
+        // Number of trailing bytes that make up the last `lines` lines (same selection as tail())
+        size_t tailLength(size_t lines, size_t head) const {
+            if (!buf_ || lines == 0) return 0;
+            const bool full = full_.load(std::memory_order_relaxed);
+            size_t stored = full ? buf_size_ : head;
+            size_t newline_count = 0;
+            size_t count = 0;
+            // Newest bytes first: [0, head) backward, then [head, buf_size_) backward once wrapped
+            for (size_t i = head; i > 0 && count < stored; ) {
+                ++count;
+                if (buf_[--i] == '\n' && ++newline_count == lines) return count;
+            }
+            for (size_t i = buf_size_; full && i > head && count < stored; ) {
+                ++count;
+                if (buf_[--i] == '\n' && ++newline_count == lines) return count;
+            }
+            return count;
+        }
+
+        // Visit the newest `count` bytes, oldest first, as at most two contiguous spans
+        template <typename Visitor>
+        void forEachSpan(size_t count, size_t head, Visitor visit) const {
+            if (count == 0) return;
+            size_t start = (head >= count) ? (head - count) : (head + buf_size_ - count);
+            size_t first = std::min(count, buf_size_ - start);
+            visit(buf_ + start, first);
+            if (first < count) {
+                visit(buf_, count - first);
             }
         }
 
     public:
+        static const size_t kMaxCapacity = 1UL << 22;
+
         explicit SerialProxy(size_t buf_size = 2048)
-            : buf_size_(buf_size), head_(0), full_(false), buf_(nullptr) {
+            : buf_size_(buf_size), head_(0), full_(false), buf_(nullptr), owns_buf_(true), written_(0), reserve_(0) {
             if (buf_size_ == 0) buf_size_ = 1; // Prevent zero-sized allocation
+            if (buf_size_ > kMaxCapacity) buf_size_ = kMaxCapacity; // Positions are 24-bit
             buf_ = new (std::nothrow) byte[buf_size_];
             if (buf_) {
                 memset(buf_, 0, buf_size_);
             }
+            resetMirrorState();
+        }
+
+        // Uses caller-owned storage (e.g. a HubMemoryUtils::BlockPool block, PSRAM, or a static array)
+        // instead of allocating; the buffer must outlive the proxy and is never freed by it.
+        SerialProxy(byte* buffer, size_t buf_size)
+            : buf_size_(buf_size), head_(0), full_(false), buf_(buffer), owns_buf_(false), written_(0), reserve_(0) {
+            if (buf_size_ > kMaxCapacity) buf_size_ = kMaxCapacity; // Positions are 24-bit
+            if (!buf_ || buf_size_ == 0) { buf_ = nullptr; buf_size_ = 1; }
+            if (buf_) {
+                memset(buf_, 0, buf_size_);
+            }
+            resetMirrorState();
         }
 
         SerialProxy(const SerialProxy&) = delete;
         SerialProxy& operator=(const SerialProxy&) = delete;
 
         SerialProxy(SerialProxy&& other) noexcept
-            : buf_size_(other.buf_size_), head_(other.head_), full_(other.full_), buf_(other.buf_) {
-            other.buf_ = nullptr; other.buf_size_ = 0; other.head_ = 0; other.full_ = false;
+            : buf_size_(other.buf_size_), head_(other.head_), full_(false), buf_(nullptr), owns_buf_(true), written_(0), reserve_(0) {
+            resetMirrorState();
+            takeFrom(other);
         }
         SerialProxy& operator=(SerialProxy&& other) noexcept {
             if (this != &other) {
-                delete[] buf_;
-                buf_size_ = other.buf_size_; head_ = other.head_; full_ = other.full_; buf_ = other.buf_;
-                other.buf_ = nullptr; other.buf_size_ = 0; other.head_ = 0; other.full_ = false;
+                stopMirrorTask();
+                if (owns_buf_) delete[] buf_;
+                takeFrom(other);
             }
             return *this;
         }
 
         ~SerialProxy() override {
-            delete[] buf_;
+            stopMirrorTask();
+            if (owns_buf_) delete[] buf_;
         }
 
         size_t write(uint8_t c) override {
-            if (Serial) { Serial.write(c); }
+            mirror(&c, 1);
             appendByte(c);
             return 1;
         }
 
         size_t write(const uint8_t *buffer, size_t size) override {
             if (!buffer || size == 0) return 0;
-            if (Serial) { Serial.write(buffer, size); }
+            mirror(buffer, size);
             appendBuffer(buffer, size);
             return size;
         }
@@ -91,14 +323,14 @@ class SerialProxy : public CachingPrinter {
         size_t write(const char *str) {
             if (!str) return 0;
             size_t len = std::strlen(str);
-            if (Serial) { Serial.write(str, len); }
+            mirror(reinterpret_cast<const uint8_t*>(str), len);
             appendBuffer(reinterpret_cast<const uint8_t*>(str), len);
             return len;
         }
 
         size_t write(const char *buffer, size_t size) {
             if (!buffer || size == 0) return 0;
-            if (Serial) { Serial.write(buffer, size); }
+            mirror(reinterpret_cast<const uint8_t*>(buffer), size);
             appendBuffer(reinterpret_cast<const uint8_t*>(buffer), size);
             return size;
         }
@@ -108,7 +340,7 @@ class SerialProxy : public CachingPrinter {
             size_t total_len = std::strlen(buffer);
             if (offset >= total_len) return 0;
             size_t clamped = std::min(size, total_len - offset);
-            if (Serial) { Serial.write(buffer + offset, clamped); }
+            mirror(reinterpret_cast<const uint8_t*>(buffer + offset), clamped);
             appendBuffer(reinterpret_cast<const uint8_t*>(buffer + offset), clamped);
             return clamped;
         }
@@ -116,55 +348,136 @@ class SerialProxy : public CachingPrinter {
         size_t write(const String &str) {
             size_t len = str.length();
             if (len == 0) return 0;
-            if (Serial) { Serial.write(str.c_str(), len); }
+            mirror(reinterpret_cast<const uint8_t*>(str.c_str()), len);
             appendBuffer(reinterpret_cast<const uint8_t*>(str.c_str()), len);
             return len;
         }
 
+        // In ASYNC mode this first sends everything still pending (blocking)
         void flush() override {
+            if (mirror_mode_ == SerialMirrorMode::ASYNC) { drain(SIZE_MAX, true); }
             if (Serial) { Serial.flush(); }
         }
 
-        std::string tail(size_t lines = 20) const override {
-            if (!buf_ || lines == 0) return std::string();
-            size_t stored = full_ ? buf_size_ : head_;
-            if (stored == 0) return std::string();
+        // Select SYNC (inline Serial.write) or ASYNC (buffer only, drained by service()).
+        // Leaving ASYNC sends whatever is still pending first; entering it starts from the current position.
+        void setMirrorMode(SerialMirrorMode mode) {
+            if (mode == mirror_mode_) return;
+            if (mirror_mode_ == SerialMirrorMode::ASYNC) {
+                stopMirrorTask();
+                drain(SIZE_MAX, true);
+            } else {
+                mirrored_ = written_.load(std::memory_order_acquire);
+            }
+            mirror_mode_ = mode;
+        }
 
-            size_t idx = (head_ == 0) ? (stored - 1) : (head_ - 1);
-            size_t newline_count = 0;
+        SerialMirrorMode getMirrorMode() const { return mirror_mode_; }
+
+        // ASYNC: send as much of the unsent region as Serial accepts without blocking; returns bytes sent.
+        // Call from loop() or let startMirrorTask() do it - not both.
+        size_t service(size_t max_bytes = SIZE_MAX) {
+            if (mirror_mode_ != SerialMirrorMode::ASYNC) return 0;
+            return drain(max_bytes, false);
+        }
+
+        // ASYNC: bytes buffered but not yet sent to Serial
+        size_t pending() const {
+            if (mirror_mode_ != SerialMirrorMode::ASYNC) return 0;
+            uint32_t unsent = distance(written_.load(std::memory_order_acquire), mirrored_);
+            return std::min<size_t>(unsent, buf_size_);
+        }
+
+        // ASYNC: bytes that were overwritten in the ring before the consumer sent them
+        uint32_t droppedBytes() const {
+            uint32_t unsent = distance(written_.load(std::memory_order_acquire), mirrored_);
+            return dropped_ + (mirror_mode_ == SerialMirrorMode::ASYNC && unsent > buf_size_ ? unsent - buf_size_ : 0);
+        }
+
+        void resetDroppedBytes() { dropped_ = 0; }
+
+#if defined(ARDUINO_ARCH_ESP32)
+        // Switch to ASYNC and drain from a low-priority FreeRTOS task every period_ms
+        bool startMirrorTask(UBaseType_t priority = 1, uint32_t period_ms = 5, uint32_t stack_size = 2048, BaseType_t core = tskNO_AFFINITY) {
+            if (mirror_task_ != nullptr) return true;
+            setMirrorMode(SerialMirrorMode::ASYNC);
+            mirror_period_ = pdMS_TO_TICKS(period_ms) > 0 ? pdMS_TO_TICKS(period_ms) : 1;
+            mirror_task_stop_ = false;
+            TaskHandle_t handle = nullptr;
+            if (xTaskCreatePinnedToCore(mirrorTaskEntry, "serial_mirror", stack_size, this, priority, &handle, core) != pdPASS) {
+                return false;
+            }
+            mirror_task_ = handle;
+            return true;
+        }
+
+        // Ask the mirror task to exit and wait for it (stays in ASYNC mode)
+        void stopMirrorTask() {
+            if (mirror_task_ == nullptr) return;
+            mirror_task_stop_ = true;
+            while (mirror_task_ != nullptr) { vTaskDelay(1); }
+        }
+
+        bool isMirrorTaskRunning() const { return mirror_task_ != nullptr; }
+#else
+        void stopMirrorTask() {}
+#endif
+
+        std::string tail(size_t lines = 20) const override {
+            size_t head = currentHead();
+            size_t count = tailLength(lines, head);
             std::string out;
-            out.reserve(stored);
-
-            bool loop = true;
-            while (loop) {
-                char ch = static_cast<char>(buf_[idx]);
-                out.push_back(ch);
-                if (ch == '\n') {
-                    ++newline_count;
-                    if (newline_count == lines) break;
-                }
-
-                if (idx == 0) {
-                    if (!full_) break; // reached start
-                    idx = buf_size_ - 1; // wrap
-                    if (idx == head_) loop = false; // buffer has only one char
-                } else {
-                    idx--;
-                    if (!full_ && idx >= head_) { loop = false; } // shouldn't happen but defensive
-                    if (full_ && idx == head_) { break; } // full wrap completed
-                }
-            }
-
-            std::reverse(out.begin(), out.end());
+            if (count == 0) return out;
+            out.reserve(count); // Exact size, not full capacity
+            forEachSpan(count, head, [&out](const uint8_t* data, size_t len) {
+                out.append(reinterpret_cast<const char*>(data), len);
+            });
             return out;
         }
 
+        // Streams the last lines straight from the ring into out (no temporary allocation)
+        size_t tail(Print& out, size_t lines = 20) const override {
+            size_t head = currentHead();
+            size_t count = tailLength(lines, head);
+            size_t written = 0;
+            forEachSpan(count, head, [&out, &written](const uint8_t* data, size_t len) {
+                written += out.write(data, len);
+            });
+            return written;
+        }
+
+        // Passes the last lines to sink as one or two contiguous spans; returns bytes visited
+        size_t tail(const TailSink& sink, size_t lines = 20) const {
+            if (!sink) return 0;
+            size_t head = currentHead();
+            size_t count = tailLength(lines, head);
+            forEachSpan(count, head, [&sink](const uint8_t* data, size_t len) {
+                sink(data, len);
+            });
+            return count;
+        }
+
         void clear() override {
             head_ = 0; full_ = false;
+            written_.store(0); reserve_.store(0); mirrored_ = 0; // Pending ASYNC output is discarded too
             if (buf_) { memset(buf_, 0, buf_size_); }
         }
 
-        size_t size() const { return full_ ? buf_size_ : head_; }
+        // Enable multi-producer writes (tasks on both cores and ISRs). Switch only while no writes are in progress.
+        // Prefer SerialMirrorMode::ASYNC with it; SYNC output written from ISR context is only buffered.
+        void setConcurrentWrites(bool enable) {
+            if (enable == concurrent_) return;
+            if (enable) {
+                reserve_.store(written_.load());
+            } else {
+                head_ = written_.load() % buf_size_;
+            }
+            concurrent_ = enable;
+        }
+
+        bool isConcurrentWrites() const { return concurrent_; }
+
+        size_t size() const { return full_ ? buf_size_ : currentHead(); }
         size_t capacity() const { return buf_size_; }
         bool wrapped() const { return full_; }
 };
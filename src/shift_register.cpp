@@ -1,6 +1,11 @@
 
 #include "shift_register.h"
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/gpio_struct.h>
+#include <soc/soc_caps.h>
+#endif
+
 ShiftRegister::ShiftRegister(uint8_t data_pin, uint8_t clock_pin, uint8_t latch_pin, uint8_t num_registers) {
     // Constrain to valid range: 1-8 registers (8-64 bits)
     num_registers = constrain(num_registers, 1, 8);
@@ -11,6 +16,14 @@ ShiftRegister::ShiftRegister(uint8_t data_pin, uint8_t clock_pin, uint8_t latch_
     this->num_bits = num_registers * 8;
     this->val = 0;
     this->dirty = false;
+    this->skip_unchanged = false;
+    this->has_latched = false;
+    this->last_latched = 0;
+    this->mode = ShiftRegisterMode::DIGITAL_WRITE;
+    #if defined(ARDUINO_ARCH_ESP32)
+    this->spi = nullptr;
+    this->spi_frequency = 0;
+    #endif
     
     // Initialize pins
     pinMode(data_pin, OUTPUT);
@@ -41,25 +54,45 @@ bool ShiftRegister::set(uint8_t index, bool value, bool update) {
     this->dirty = true;
 
     if (update) {
-        this->update();
+        this->push_updates();
     }
     
     return true;
 }
 
 void ShiftRegister::setAll(bool value) {
-    if (value) {
-        // Safe way to set all bits without undefined behavior
-        if (this->num_bits == 64) {
-            this->val = 0xFFFFFFFFFFFFFFFFULL;
-        } else {
-            this->val = (1ULL << this->num_bits) - 1;
-        }
-    } else {
-        this->val = 0;
+    this->val = value ? this->validMask() : 0;
+    this->dirty = true;
+    this->push_updates();
+}
+
+void ShiftRegister::setMask(uint64_t mask, uint64_t values) {
+    mask &= this->validMask();
+    this->val = (this->val & ~mask) | (values & mask);
+    this->dirty = true;
+}
+
+bool ShiftRegister::setByte(uint8_t reg, uint8_t value) {
+    if (reg >= this->num_bits / 8) {
+        return false;
     }
+    const uint8_t shift = reg * 8;
+    this->val = (this->val & ~(0xFFULL << shift)) | (static_cast<uint64_t>(value) << shift);
     this->dirty = true;
-    this->update();
+    return true;
+}
+
+void ShiftRegister::setValue(uint64_t value) {
+    this->val = value & this->validMask();
+    this->dirty = true;
+}
+
+uint64_t ShiftRegister::validMask() const {
+    // Safe way to set all bits without undefined behavior
+    if (this->num_bits == 64) {
+        return 0xFFFFFFFFFFFFFFFFULL;
+    }
+    return (1ULL << this->num_bits) - 1;
 }
 
 void ShiftRegister::clear() {
@@ -67,8 +100,15 @@ void ShiftRegister::clear() {
 }
 
 void ShiftRegister::push_updates(bool force) {
-    if (!this->dirty && !force) {
-        return;
+    if (!force) {
+        if (!this->dirty) {
+            return;
+        }
+        if (this->skip_unchanged && this->has_latched && this->val == this->last_latched) {
+            // Outputs already show this state; no need to shift it out again
+            this->dirty = false;
+            return;
+        }
     }
     this->update();
 }
@@ -80,19 +120,77 @@ bool ShiftRegister::get(uint8_t index) const {
     return (this->val & (1ULL << index)) != 0;
 }
 
+void ShiftRegister::useDigitalWrite() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (this->spi) {
+        this->spi->end();
+        this->spi = nullptr;
+        pinMode(this->data_pin, OUTPUT);
+        pinMode(this->clock_pin, OUTPUT);
+    }
+    #endif
+    this->mode = ShiftRegisterMode::DIGITAL_WRITE;
+}
+
+bool ShiftRegister::useFastGPIO() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    this->useDigitalWrite();
+    this->mode = ShiftRegisterMode::FAST_GPIO;
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+bool ShiftRegister::useSPI(SPIClass& spi, uint32_t frequency) {
+    if (frequency == 0) {
+        return false;
+    }
+    // Route SCK to the clock pin and MOSI to the data pin; no MISO/SS needed.
+    spi.begin(this->clock_pin, -1, this->data_pin, -1);
+    this->spi = &spi;
+    this->spi_frequency = frequency;
+    this->mode = ShiftRegisterMode::SPI_BUS;
+    return true;
+}
+#endif
+
 void ShiftRegister::update() {
+    switch (this->mode) {
+        case ShiftRegisterMode::FAST_GPIO:
+            this->updateFastGPIO();
+            break;
+        case ShiftRegisterMode::SPI_BUS:
+            this->updateSPI();
+            break;
+        default:
+            this->updateDigitalWrite();
+            break;
+    }
+    
+    // Clear dirty flag after successful update
+    this->dirty = false;
+    this->last_latched = this->val;
+    this->has_latched = true;
+}
+
+void ShiftRegister::updateDigitalWrite() {
     // Begin latch sequence
     digitalWrite(this->latch_pin, LOW);
     
-    // Shift out data MSB first
-    for (int i = 0; i < this->num_bits; i++) {
+    // Shift out data MSB first, walking a single mask down from the top bit
+    uint64_t mask = 1ULL << (this->num_bits - 1);
+    bool data_high = false;
+    digitalWrite(this->data_pin, LOW);
+    for (uint8_t i = 0; i < this->num_bits; i++, mask >>= 1) {
         digitalWrite(this->clock_pin, LOW);
         
-        // Check bit at position (num_bits - 1 - i) for MSB first
-        if (this->val & (1ULL << (this->num_bits - 1 - i))) {
-            digitalWrite(this->data_pin, HIGH);
-        } else {
-            digitalWrite(this->data_pin, LOW);
+        // Only touch the data pin when the bit differs from the previous one
+        bool bit = (this->val & mask) != 0;
+        if (bit != data_high) {
+            digitalWrite(this->data_pin, bit ? HIGH : LOW);
+            data_high = bit;
         }
         
         // Clock pulse to shift in the bit
@@ -104,7 +202,67 @@ void ShiftRegister::update() {
     
     // Complete latch sequence - transfer data to outputs
     digitalWrite(this->latch_pin, HIGH);
-    
-    // Clear dirty flag after successful update
-    this->dirty = false;
+}
+
+void ShiftRegister::updateFastGPIO() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    // Resolve set/clear registers and masks once per update rather than per bit
+    #if SOC_GPIO_PIN_COUNT > 32
+    volatile uint32_t* data_set  = this->data_pin  < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val;
+    volatile uint32_t* data_clr  = this->data_pin  < 32 ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val;
+    volatile uint32_t* clock_set = this->clock_pin < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val;
+    volatile uint32_t* clock_clr = this->clock_pin < 32 ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val;
+    volatile uint32_t* latch_set = this->latch_pin < 32 ? &GPIO.out_w1ts : &GPIO.out1_w1ts.val;
+    volatile uint32_t* latch_clr = this->latch_pin < 32 ? &GPIO.out_w1tc : &GPIO.out1_w1tc.val;
+    #else
+    volatile uint32_t* data_set  = &GPIO.out_w1ts;
+    volatile uint32_t* data_clr  = &GPIO.out_w1tc;
+    volatile uint32_t* clock_set = &GPIO.out_w1ts;
+    volatile uint32_t* clock_clr = &GPIO.out_w1tc;
+    volatile uint32_t* latch_set = &GPIO.out_w1ts;
+    volatile uint32_t* latch_clr = &GPIO.out_w1tc;
+    #endif
+    const uint32_t data_mask  = 1UL << (this->data_pin & 31);
+    const uint32_t clock_mask = 1UL << (this->clock_pin & 31);
+    const uint32_t latch_mask = 1UL << (this->latch_pin & 31);
+
+    *latch_clr = latch_mask;
+    uint64_t mask = 1ULL << (this->num_bits - 1);
+    for (uint8_t i = 0; i < this->num_bits; i++, mask >>= 1) {
+        *clock_clr = clock_mask;
+        if (this->val & mask) {
+            *data_set = data_mask;
+        } else {
+            *data_clr = data_mask;
+        }
+        *clock_set = clock_mask;
+    }
+    *data_clr = data_mask;
+    *latch_set = latch_mask;
+    #else
+    this->updateDigitalWrite();
+    #endif
+}
+
+void ShiftRegister::updateSPI() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    if (!this->spi) {
+        this->updateDigitalWrite();
+        return;
+    }
+    // Highest register first, MSB first within each byte (same order as the bit-bang path)
+    uint8_t bytes[8];
+    const uint8_t num_registers = this->num_bits / 8;
+    for (uint8_t i = 0; i < num_registers; i++) {
+        bytes[i] = static_cast<uint8_t>(this->val >> (8 * (num_registers - 1 - i)));
+    }
+
+    digitalWrite(this->latch_pin, LOW);
+    this->spi->beginTransaction(SPISettings(this->spi_frequency, MSBFIRST, SPI_MODE0));
+    this->spi->writeBytes(bytes, num_registers);
+    this->spi->endTransaction();
+    digitalWrite(this->latch_pin, HIGH);
+    #else
+    this->updateDigitalWrite();
+    #endif
 }
@@ -3,6 +3,22 @@
 
 #include <Arduino.h>
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <SPI.h>
+#endif
+
+/**
+ * @brief How ShiftRegister::update() drives the data/clock/latch pins.
+ * - DIGITAL_WRITE: portable bit-bang using digitalWrite (default)
+ * - FAST_GPIO: bit-bang through the ESP32 GPIO set/clear registers (ESP32 only)
+ * - SPI_BUS: shift whole bytes out through an SPI peripheral (ESP32 only)
+ */
+enum class ShiftRegisterMode : uint8_t {
+    DIGITAL_WRITE,
+    FAST_GPIO,
+    SPI_BUS
+};
+
 class ShiftRegister {
     private: 
         uint8_t data_pin;
@@ -11,13 +27,73 @@ class ShiftRegister {
         uint8_t num_bits;
         uint64_t val;  // Changed from unsigned long to support up to 8 registers (64 bits)
         bool dirty;
+        bool skip_unchanged;
+        bool has_latched;
+        uint64_t last_latched;  // Value most recently latched to the outputs (valid when has_latched)
+        ShiftRegisterMode mode;
+        #if defined(ARDUINO_ARCH_ESP32)
+        SPIClass* spi;
+        uint32_t spi_frequency;
+        #endif
         void update();
+        uint64_t validMask() const;
+        void updateDigitalWrite();
+        void updateFastGPIO();
+        void updateSPI();
     public:
         ShiftRegister(uint8_t data_pin, uint8_t clock_pin, uint8_t latch_pin, uint8_t num_registers = 1);
         bool set(uint8_t index, bool value, bool update = true);
         void setAll(bool value);
         void clear();
         void push_updates(bool force = false);
+
+        /**
+         * @brief Set every output selected by mask to the matching bit in values (deferred until push_updates()).
+         * @param mask Bit i selects output i; bits beyond getNumBits() are ignored
+         * @param values New state for the selected outputs
+         */
+        void setMask(uint64_t mask, uint64_t values);
+
+        /**
+         * @brief Set all 8 outputs of one register (deferred until push_updates()).
+         * @param reg Register index, 0 is outputs 0-7
+         * @param value Output states, bit 0 is the lowest output of the register
+         * @return false if reg is out of range
+         */
+        bool setByte(uint8_t reg, uint8_t value);
+
+        /**
+         * @brief Replace the whole output state (deferred until push_updates()); bits beyond getNumBits() are ignored.
+         */
+        void setValue(uint64_t value);
+
+        /**
+         * @brief When enabled, pushes (including set(..., true) and setAll()) skip the latch entirely
+         *        if the state matches the value last latched, even when dirty. push_updates(true) always latches.
+         */
+        void setSkipUnchanged(bool enabled) { skip_unchanged = enabled; }
+        bool isSkipUnchanged() const { return skip_unchanged; }
+
+        /**
+         * @brief Use the portable digitalWrite bit-bang backend (the default).
+         */
+        void useDigitalWrite();
+
+        /**
+         * @brief Bit-bang through the GPIO set/clear (W1TS/W1TC) registers instead of digitalWrite.
+         * @return true if supported on this platform (ESP32), false otherwise (backend unchanged)
+         */
+        bool useFastGPIO();
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Shift whole bytes out through an SPI peripheral.
+         * @param spi The SPI bus to use; it is (re)started with SCK on clock_pin and MOSI on data_pin
+         * @param frequency SPI clock in Hz (default 10MHz, within 74HC595 limits at 3.3V)
+         * @note The bus is dedicated to the shift register chain; the latch pin is still driven as a GPIO.
+         */
+        bool useSPI(SPIClass& spi = SPI, uint32_t frequency = 10000000);
+        #endif
         
         // Query methods for testing and debugging
         bool get(uint8_t index) const;
@@ -25,6 +101,7 @@ class ShiftRegister {
         uint8_t getNumRegisters() const { return num_bits / 8; }
         uint64_t getValue() const { return val; }
         bool isDirty() const { return dirty; }
+        ShiftRegisterMode getMode() const { return mode; }
 };
 
 #endif  // HUB_SHIFT_REGISTER_H
\ No newline at end of file
@@ -4,9 +4,81 @@
 #include <Arduino.h>
 #include <string>
 #include <vector>
+#include <cstring>
 
 namespace HubStringUtils {
 
+namespace detail {
+
+/** @brief Loads 4 bytes from an arbitrarily aligned pointer (compiles to a single load where allowed). */
+inline uint32_t loadWord(const char* ptr) noexcept {
+  uint32_t word;
+  memcpy(&word, ptr, sizeof(word));
+  return word;
+}
+
+/**
+ * @brief Marks the continuation bytes (10xxxxxx) of a 4-byte word.
+ *
+ * Shifting left by one moves each byte's bit 6 under its bit 7 (bit 7 spills into
+ * the next lane, which the mask discards), so bit 7 of a lane survives only for
+ * 10xxxxxx. The result has 0x01 in every continuation lane and 0x00 elsewhere.
+ */
+inline uint32_t continuationLanes(uint32_t word) noexcept {
+  return ((word & ~(word << 1)) & 0x80808080u) >> 7;
+}
+
+} // namespace detail
+
+/**
+ * @brief Calculates the number of UTF-8 characters in a byte buffer.
+ * 
+ * Counts every byte that is not a continuation byte (10xxxxxx), processing four
+ * bytes per step: continuation lanes are summed as packed per-byte counters and
+ * folded once every 255 words, so the inner loop is a load, three ALU ops and an add.
+ * 
+ * @param data Pointer to the UTF-8 bytes (need not be aligned or null-terminated)
+ * @param len Number of bytes to examine
+ * @return The number of UTF-8 characters (not bytes)
+ * 
+ * @note Stray continuation bytes are not counted; other invalid bytes count as one character each.
+ *       Use utf8Validate() first when the input is untrusted.
+ * @note Performance: O(n), roughly 4x fewer iterations than a byte loop
+ */
+inline size_t utf8CharCount(const char* data, size_t len) noexcept {
+  if (data == nullptr) {
+    return 0;
+  }
+
+  size_t continuation = 0;
+  size_t i = 0;
+
+  while (len - i >= sizeof(uint32_t)) {
+    // Each lane can hold 255 before it would carry into its neighbour
+    size_t words = (len - i) / sizeof(uint32_t);
+    if (words > 255) {
+      words = 255;
+    }
+
+    uint32_t lanes = 0;
+    for (size_t w = 0; w < words; ++w, i += sizeof(uint32_t)) {
+      lanes += detail::continuationLanes(detail::loadWord(data + i));
+    }
+
+    // Horizontal sum of the four 8-bit lanes
+    lanes = (lanes & 0x00FF00FFu) + ((lanes >> 8) & 0x00FF00FFu);
+    continuation += (lanes & 0xFFFFu) + (lanes >> 16);
+  }
+
+  for (; i < len; ++i) {
+    if ((static_cast<unsigned char>(data[i]) & 0xC0) == 0x80) {
+      ++continuation;
+    }
+  }
+
+  return len - continuation;
+}
+
 /**
  * @brief Calculates the number of UTF-8 characters in an Arduino String.
  * 
@@ -16,44 +88,115 @@ namespace HubStringUtils {
  * @param str The Arduino String to measure
  * @return The number of UTF-8 characters (not bytes)
  * 
- * @note Invalid UTF-8 sequences are counted byte-by-byte as separate characters.
- * @note Performance: O(n) where n is the byte length of the string
+ * @note Stray continuation bytes are not counted; other invalid bytes count as one character each.
+ * @note Performance: O(n) where n is the byte length of the string (word-at-a-time)
  */
 inline size_t utf8CharCount(const String& str) noexcept {
-  size_t char_count = 0;
-  const char* ptr = str.c_str();
-  const size_t len = str.length();
-  
-  for (size_t i = 0; i < len; ++i) {
-    const unsigned char c = static_cast<unsigned char>(ptr[i]);
-    
-    // Count only the start of UTF-8 sequences (not continuation bytes)
-    // Continuation bytes have the pattern 10xxxxxx (0x80-0xBF)
-    if ((c & 0xC0) != 0x80) {
-      ++char_count;
-    }
-  }
-  
-  return char_count;
+  return utf8CharCount(str.c_str(), str.length());
 }
 
 /**
- * @brief Calculates the UTF-8 byte length required to encode an Arduino String.
+ * @brief Returns the byte length of an Arduino String's UTF-8 representation.
  * 
- * For strings already in UTF-8 format, this returns the same as str.length().
- * This function validates UTF-8 sequences and counts the total bytes needed.
+ * Arduino Strings are stored as UTF-8 already, so this is exactly str.length().
+ * No validation is performed; use utf8Validate() to check the contents.
  * 
  * @param str The Arduino String to measure
  * @return The number of bytes in the UTF-8 representation
  * 
- * @note This is primarily useful for validation or conversion scenarios
- * @note Performance: O(n) where n is the byte length of the string
+ * @note Performance: O(1)
  */
 inline size_t utf8ByteLength(const String& str) noexcept {
   // Arduino Strings are already UTF-8 encoded in memory
   return str.length();
 }
 
+/**
+ * @brief Validates a UTF-8 byte buffer and returns the offset of the first invalid sequence.
+ * 
+ * Applies the strict RFC 3629 rules: overlong encodings, UTF-16 surrogates
+ * (U+D800..U+DFFF), code points above U+10FFFF, stray continuation bytes and
+ * sequences truncated by the end of the buffer are all rejected. Runs of ASCII
+ * are skipped four bytes per step, so mostly-ASCII text validates at word speed.
+ * 
+ * @param data Pointer to the bytes (need not be aligned or null-terminated)
+ * @param len Number of bytes to examine
+ * @return Offset of the lead byte of the first invalid sequence, or len if the buffer is valid
+ * 
+ * Example:
+ *   utf8Validate("h\xC3\xA9llo", 6) → 6  (valid)
+ *   utf8Validate("ab\xC0\xAF", 4)   → 2  (overlong '/')
+ *   utf8Validate("ok\xE2\x82", 4)   → 2  (truncated)
+ */
+inline size_t utf8Validate(const char* data, size_t len) noexcept {
+  if (data == nullptr) {
+    return 0;
+  }
+
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  size_t i = 0;
+
+  while (i < len) {
+    // ASCII fast path: skip whole words with no high bits set
+    while (len - i >= sizeof(uint32_t) && (detail::loadWord(data + i) & 0x80808080u) == 0) {
+      i += sizeof(uint32_t);
+    }
+    if (i >= len) {
+      break;
+    }
+
+    const unsigned char lead = bytes[i];
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+
+    size_t need;
+    unsigned char lo = 0x80;  // Allowed range of the first continuation byte
+    unsigned char hi = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      need = 1;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      need = 2;
+      if (lead == 0xE0) lo = 0xA0;        // Overlong
+      else if (lead == 0xED) hi = 0x9F;   // Surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      need = 3;
+      if (lead == 0xF0) lo = 0x90;        // Overlong
+      else if (lead == 0xF4) hi = 0x8F;   // Above U+10FFFF
+    } else {
+      return i;  // Continuation byte, C0/C1 overlong lead or F5..FF
+    }
+
+    if (len - i <= need) {
+      return i;  // Truncated
+    }
+    if (bytes[i + 1] < lo || bytes[i + 1] > hi) {
+      return i;
+    }
+    for (size_t k = 2; k <= need; ++k) {
+      if ((bytes[i + k] & 0xC0) != 0x80) {
+        return i;
+      }
+    }
+    i += need + 1;
+  }
+
+  return len;
+}
+
+/**
+ * @brief Validates an Arduino String as UTF-8.
+ * 
+ * @param str The Arduino String to check
+ * @return Offset of the first invalid sequence, or str.length() if the string is valid UTF-8
+ * 
+ * @see utf8Validate(const char*, size_t)
+ */
+inline size_t utf8Validate(const String& str) noexcept {
+  return utf8Validate(str.c_str(), str.length());
+}
+
 /**
  * @brief Splits a std::string into tokens based on a delimiter character.
  * 
@@ -219,12 +362,235 @@ inline String trim(const String& str) {
   return str.substring(start, end + 1);
 }
 
+/**
+ * @brief Non-owning view of a character range (pointer + length).
+ * 
+ * A lightweight C++11 stand-in for std::string_view. It never allocates and
+ * never copies, so it is only valid while the underlying buffer is alive and
+ * unmodified. The data is not NUL-terminated; always use length.
+ * 
+ * @note Convert with str() / toString() when an owning copy is needed
+ */
+struct StringView {
+  const char* data;
+  size_t length;
+
+  StringView() noexcept : data(""), length(0) {}
+  StringView(const char* ptr, size_t len) noexcept : data(ptr), length(len) {}
+  StringView(const char* cstr) noexcept : data(cstr ? cstr : ""), length(cstr ? std::strlen(cstr) : 0) {}
+  StringView(const std::string& str) noexcept : data(str.data()), length(str.length()) {}
+  StringView(const String& str) noexcept : data(str.c_str()), length(str.length()) {}
+
+  bool empty() const noexcept { return length == 0; }
+  size_t size() const noexcept { return length; }
+  const char* begin() const noexcept { return data; }
+  const char* end() const noexcept { return data + length; }
+  char operator[](size_t i) const noexcept { return data[i]; }
+
+  bool equals(StringView other) const noexcept {
+    return length == other.length && (length == 0 || std::memcmp(data, other.data, length) == 0);
+  }
+  bool operator==(StringView other) const noexcept { return equals(other); }
+  bool operator!=(StringView other) const noexcept { return !equals(other); }
+
+  bool startsWith(StringView prefix) const noexcept {
+    return prefix.length <= length && (prefix.length == 0 || std::memcmp(data, prefix.data, prefix.length) == 0);
+  }
+
+  /** @brief Returns the sub-view [pos, pos + count), clamped to the view */
+  StringView substr(size_t pos, size_t count = static_cast<size_t>(-1)) const noexcept {
+    if (pos > length) pos = length;
+    if (count > length - pos) count = length - pos;
+    return StringView(data + pos, count);
+  }
+
+  std::string str() const { return std::string(data, length); }
+
+  String toString() const {
+    String out;
+    out.reserve(length);
+    for (size_t i = 0; i < length; ++i) out += data[i];
+    return out;
+  }
+};
+
+/**
+ * @brief Lazy, allocation-free tokenizer yielding StringView tokens.
+ * 
+ * Produces exactly the tokens split() would, without building a vector or
+ * copying any characters. Tokens point into the original buffer.
+ * 
+ * @note The source buffer must outlive the tokenizer and its tokens
+ * 
+ * Example:
+ *   Tokenizer tok(line, ' ');
+ *   StringView word;
+ *   while (tok.next(word)) { ... }
+ */
+class Tokenizer {
+  public:
+    Tokenizer(StringView source, char delimiter, bool keep_empty = false) noexcept
+      : pos_(source.data), end_(source.data + source.length), delimiter_(delimiter),
+        keep_empty_(keep_empty), done_(source.length == 0) {}
+
+    /**
+     * @brief Advances to the next token
+     * @param token Receives the token view
+     * @return false when no tokens remain
+     */
+    bool next(StringView& token) noexcept {
+      while (!done_) {
+        const char* hit = static_cast<const char*>(std::memchr(pos_, delimiter_, end_ - pos_));
+        const char* stop = hit ? hit : end_;
+        token = StringView(pos_, stop - pos_);
+        if (hit) {
+          pos_ = hit + 1;
+        } else {
+          pos_ = end_;
+          done_ = true;
+        }
+        if (keep_empty_ || !token.empty()) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /** @brief Unconsumed remainder of the source (e.g. the rest of a command line) */
+    StringView rest() const noexcept { return done_ ? StringView(end_, 0) : StringView(pos_, end_ - pos_); }
+
+  private:
+    const char* pos_;
+    const char* end_;
+    char delimiter_;
+    bool keep_empty_;
+    bool done_;
+};
+
+/**
+ * @brief Range adaptor over Tokenizer for range-based for loops (see splitView()).
+ */
+class SplitRange {
+  public:
+    class iterator {
+      public:
+        iterator() noexcept : tokenizer_(StringView(), 0), valid_(false) {}
+        explicit iterator(const Tokenizer& tokenizer) noexcept : tokenizer_(tokenizer), valid_(true) { ++*this; }
+
+        const StringView& operator*() const noexcept { return token_; }
+        const StringView* operator->() const noexcept { return &token_; }
+        iterator& operator++() noexcept { valid_ = tokenizer_.next(token_); return *this; }
+        bool operator==(const iterator& other) const noexcept { return valid_ == other.valid_ && (!valid_ || token_.data == other.token_.data); }
+        bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+
+      private:
+        Tokenizer tokenizer_;
+        StringView token_;
+        bool valid_;
+    };
+
+    SplitRange(StringView source, char delimiter, bool keep_empty) noexcept : tokenizer_(source, delimiter, keep_empty) {}
+
+    iterator begin() const noexcept { return iterator(tokenizer_); }
+    iterator end() const noexcept { return iterator(); }
+
+  private:
+    Tokenizer tokenizer_;
+};
+
+/**
+ * @brief Zero-allocation split: iterates the same tokens as split() as StringViews.
+ * 
+ * @param str The text to split (std::string, String, C string or StringView)
+ * @param delimiter The character to split on
+ * @param keep_empty If true, consecutive delimiters produce empty tokens (default: false)
+ * @return A lazily evaluated range of StringView tokens
+ * 
+ * @note Nothing is copied; tokens are only valid while str is alive and unmodified
+ * @note Do not pass a temporary (e.g. String("a,b")) - the tokens would dangle
+ * 
+ * Example:
+ *   for (StringView pair : splitView(query, '&')) {
+ *     Tokenizer kv(pair, '=', true);
+ *     StringView key, value;
+ *     kv.next(key); kv.next(value);
+ *   }
+ */
+inline SplitRange splitView(StringView str, char delimiter, bool keep_empty = false) noexcept {
+  return SplitRange(str, delimiter, keep_empty);
+}
+
+namespace detail {
+  // Copy a token into a String (non-template, so preferred) or any std::basic_string
+  inline void assignToken(String& out, StringView token) { out = token.toString(); }
+  template <typename Str>
+  inline void assignToken(Str& out, StringView token) { out.assign(token.data, token.length); }
+}
+
+/**
+ * @brief Splits into a caller-supplied container instead of returning a new vector.
+ * 
+ * Appends the same tokens split() would produce to out, so the container (and its
+ * allocator) is chosen by the caller - e.g. a std::vector<String, ArenaAllocator<String>>
+ * backed by a HubMemoryUtils::FrameArena, or a vector reused across calls.
+ * 
+ * @param str The text to split (std::string, String, C string or StringView)
+ * @param delimiter The character to split on
+ * @param out Container of String or std::string tokens (anything with emplace_back() and back())
+ * @param keep_empty If true, consecutive delimiters produce empty tokens (default: false)
+ * @return The number of tokens appended
+ * 
+ * Example:
+ *   std::vector<String> fields;
+ *   fields.reserve(8);
+ *   while (readLine(line)) {
+ *     fields.clear();            // Keeps capacity; no vector reallocation per line
+ *     splitInto(line, ',', fields);
+ *   }
+ */
+template <typename Container>
+inline size_t splitInto(StringView str, char delimiter, Container& out, bool keep_empty = false) {
+  Tokenizer tokenizer(str, delimiter, keep_empty);
+  StringView token;
+  size_t count = 0;
+  while (tokenizer.next(token)) {
+    out.emplace_back();
+    detail::assignToken(out.back(), token);
+    ++count;
+  }
+  return count;
+}
+
+/**
+ * @brief Trims whitespace from both ends without copying.
+ * 
+ * @param str The text to trim (std::string, String, C string or StringView)
+ * @return A view of str with leading and trailing whitespace removed
+ * 
+ * @note Whitespace includes: space, tab, newline, carriage return, form feed, vertical tab
+ * @note The view is only valid while str is alive and unmodified
+ */
+inline StringView trimView(StringView str) noexcept {
+  const char* start = str.data;
+  const char* end = str.data + str.length;
+  auto is_space = [](char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }; // \t \n \v \f \r
+  while (start < end && is_space(*start)) ++start;
+  while (end > start && is_space(*(end - 1))) --end;
+  return StringView(start, end - start);
+}
+
 } // namespace HubStringUtils
 
 // Convenience: allow unqualified usage (optional - can be removed for stricter namespacing)
 using HubStringUtils::utf8CharCount;
 using HubStringUtils::utf8ByteLength;
+using HubStringUtils::utf8Validate;
 using HubStringUtils::split;
 using HubStringUtils::trim;
+using HubStringUtils::StringView;
+using HubStringUtils::Tokenizer;
+using HubStringUtils::splitView;
+using HubStringUtils::splitInto;
+using HubStringUtils::trimView;
 
 #endif // HUB_STRING_UTILS_H
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "tick_hub.h"
+
+static const TickTaskStats kEmptyStats = {};
+
+TickHub::TickHub() {
+    this->count = 0;
+    this->stats_start_us = micros();
+    this->busy_us = 0;
+    for (uint8_t i = 0; i < kMaxTasks; i++) {
+        this->tasks[i].name = nullptr;
+        this->tasks[i].period_us = 0;
+        this->tasks[i].next_due_us = 0;
+        this->tasks[i].priority = 0;
+        this->tasks[i].used = false;
+        this->tasks[i].enabled = false;
+        this->tasks[i].restart = false;
+        this->tasks[i].stats = kEmptyStats;
+    }
+    #if defined(ARDUINO_ARCH_ESP32)
+    this->task_handle = nullptr;
+    this->task_stop = false;
+    this->wake_timer = nullptr;
+    #endif
+}
+
+TickHub::~TickHub() {
+    #if defined(ARDUINO_ARCH_ESP32)
+    this->stopTask();
+    #endif
+}
+
+bool TickHub::validId(int8_t id) const {
+    return id >= 0 && id < (int8_t)kMaxTasks && this->tasks[id].used;
+}
+
+int8_t TickHub::add(const char* name, const TaskFunction& function, uint32_t period_us, uint8_t priority) {
+    if (!function) {
+        return kInvalidTask;
+    }
+    if (period_us > kMaxPeriodUs) {
+        period_us = kMaxPeriodUs;
+    }
+
+    for (uint8_t i = 0; i < kMaxTasks; i++) {
+        Task& task = this->tasks[i];
+        if (task.used) {
+            continue;
+        }
+
+        task.function = function;
+        task.name = name;
+        task.period_us = period_us;
+        task.next_due_us = micros();
+        task.priority = priority;
+        task.stats = kEmptyStats;
+        task.restart = false;
+        task.enabled = true;
+        task.used = true;              // Published last: tick() skips the slot until now
+        this->count++;
+        this->wake();
+        return (int8_t)i;
+    }
+    return kInvalidTask;
+}
+
+void TickHub::remove(int8_t id) {
+    if (!this->validId(id)) {
+        return;
+    }
+
+    Task& task = this->tasks[id];
+    // The callback is left in place (overwritten by the next add()) so removing from inside it is safe
+    task.enabled = false;
+    task.used = false;
+    this->count--;
+}
+
+void TickHub::setEnabled(int8_t id, bool enabled) {
+    if (!this->validId(id)) {
+        return;
+    }
+
+    Task& task = this->tasks[id];
+    if (enabled && !task.enabled) {
+        task.restart = true;
+    }
+    task.enabled = enabled;
+    if (enabled) {
+        this->wake();
+    }
+}
+
+bool TickHub::isEnabled(int8_t id) const {
+    return this->validId(id) && this->tasks[id].enabled;
+}
+
+void TickHub::setPeriod(int8_t id, uint32_t period_us) {
+    if (!this->validId(id)) {
+        return;
+    }
+    if (period_us > kMaxPeriodUs) {
+        period_us = kMaxPeriodUs;
+    }
+    this->tasks[id].period_us = period_us;
+    this->wake();
+}
+
+uint32_t TickHub::getPeriod(int8_t id) const {
+    return this->validId(id) ? this->tasks[id].period_us : 0;
+}
+
+uint8_t TickHub::size() const {
+    return this->count;
+}
+
+const TickTaskStats& TickHub::getStats(int8_t id) const {
+    return this->validId(id) ? this->tasks[id].stats : kEmptyStats;
+}
+
+const char* TickHub::getName(int8_t id) const {
+    return this->validId(id) ? this->tasks[id].name : nullptr;
+}
+
+void TickHub::run(uint8_t index, uint32_t now_us) {
+    Task& task = this->tasks[index];
+    TickTaskStats& stats = task.stats;
+    const uint32_t period = task.period_us;
+
+    // Schedule the next run before calling out, so the callback may change or remove the task
+    uint32_t late = now_us - task.next_due_us;
+    if (late > stats.max_late_us) {
+        stats.max_late_us = late;
+    }
+    if (period == 0) {
+        task.next_due_us = now_us;
+    } else if (late >= period) {
+        // A whole period or more behind: skip the missed slots instead of running back-to-back
+        stats.missed += late / period;
+        task.next_due_us = now_us + period;
+    } else {
+        task.next_due_us += period;
+    }
+
+    uint32_t start = micros();
+    task.function();
+    uint32_t exec = micros() - start;
+
+    stats.runs++;
+    stats.last_exec_us = exec;
+    stats.total_exec_us += exec;
+    if (exec > stats.max_exec_us) {
+        stats.max_exec_us = exec;
+    }
+    if (period != 0 && exec > period) {
+        stats.overruns++;
+    }
+    this->busy_us += exec;
+}
+
+uint32_t TickHub::tick() {
+    uint32_t ran_mask = 0;
+
+    for (;;) {
+        uint32_t now = micros();
+        int8_t best = kInvalidTask;
+        uint32_t best_late = 0;
+
+        for (uint8_t i = 0; i < kMaxTasks; i++) {
+            Task& task = this->tasks[i];
+            if (!task.used || !task.enabled || (ran_mask & (1UL << i))) {
+                continue;
+            }
+            if (task.restart) {
+                task.restart = false;
+                task.next_due_us = now;
+            }
+
+            int32_t late = (int32_t)(now - task.next_due_us);
+            if (late < 0) {
+                continue;
+            }
+            if (best == kInvalidTask || task.priority > this->tasks[best].priority ||
+                (task.priority == this->tasks[best].priority && (uint32_t)late > best_late)) {
+                best = (int8_t)i;
+                best_late = (uint32_t)late;
+            }
+        }
+
+        if (best == kInvalidTask) {
+            break;
+        }
+        ran_mask |= 1UL << best;
+        this->run((uint8_t)best, now);
+    }
+
+    // Time until the earliest enabled task is due
+    uint32_t now = micros();
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t i = 0; i < kMaxTasks; i++) {
+        const Task& task = this->tasks[i];
+        if (!task.used || !task.enabled) {
+            continue;
+        }
+        if (task.restart) {
+            return 0;
+        }
+        int32_t until = (int32_t)(task.next_due_us - now);
+        if (until <= 0) {
+            return 0;
+        }
+        if ((uint32_t)until < wait) {
+            wait = (uint32_t)until;
+        }
+    }
+    return wait;
+}
+
+float TickHub::getUtilization() const {
+    uint32_t elapsed = micros() - this->stats_start_us;
+    if (elapsed == 0) {
+        return 0.0f;
+    }
+    return 100.0f * (float)this->busy_us / (float)elapsed;
+}
+
+void TickHub::resetStats() {
+    for (uint8_t i = 0; i < kMaxTasks; i++) {
+        this->tasks[i].stats = kEmptyStats;
+    }
+    this->busy_us = 0;
+    this->stats_start_us = micros();
+}
+
+void TickHub::printStats(Print& out) const {
+    out.println("task             period_us prio     runs  overrun   missed   avg_us   max_us  late_us");
+    char line[112];
+    for (uint8_t i = 0; i < kMaxTasks; i++) {
+        const Task& task = this->tasks[i];
+        if (!task.used) {
+            continue;
+        }
+        const TickTaskStats& s = task.stats;
+        snprintf(line, sizeof(line), "%-16.16s %9lu %4u %8lu %8lu %8lu %8lu %8lu %8lu%s",
+                 task.name ? task.name : "?", (unsigned long)task.period_us, (unsigned)task.priority,
+                 (unsigned long)s.runs, (unsigned long)s.overruns, (unsigned long)s.missed,
+                 (unsigned long)s.avgExecUs(), (unsigned long)s.max_exec_us, (unsigned long)s.max_late_us,
+                 task.enabled ? "" : " (paused)");
+        out.println(line);
+    }
+    snprintf(line, sizeof(line), "utilization %.1f%%", this->getUtilization());
+    out.println(line);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+void TickHub::wake() {
+    TaskHandle_t handle = this->task_handle;
+    if (handle != nullptr) {
+        xTaskNotifyGive(handle);
+    }
+}
+
+void TickHub::timerCallback(void* arg) {
+    static_cast<TickHub*>(arg)->wake();
+}
+
+void TickHub::taskEntry(void* arg) {
+    TickHub* self = static_cast<TickHub*>(arg);
+    while (!self->task_stop) {
+        uint32_t wait = self->tick();
+        if (wait == 0) {
+            // Work is still due after a full pass (period 0 or an overrunning job): block for one
+            // RTOS tick anyway so loop() and the IDLE task on this core are not starved.
+            ulTaskNotifyTake(pdTRUE, 1);
+            continue;
+        }
+        esp_timer_stop(self->wake_timer);
+        if (wait != UINT32_MAX) {
+            esp_timer_start_once(self->wake_timer, wait);
+        }
+        // Woken by the timer, by add()/setEnabled()/setPeriod(), or by stopTask()
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    esp_timer_stop(self->wake_timer);
+    self->task_handle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+bool TickHub::startTask(UBaseType_t priority, BaseType_t core, uint32_t stack_size) {
+    if (this->task_handle != nullptr) {
+        return true;
+    }
+
+    if (this->wake_timer == nullptr) {
+        esp_timer_create_args_t args = {};
+        args.callback = &TickHub::timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "tick_hub";
+        if (esp_timer_create(&args, &this->wake_timer) != ESP_OK) {
+            this->wake_timer = nullptr;
+            return false;
+        }
+    }
+
+    this->task_stop = false;
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(taskEntry, "tick_hub", stack_size, this, priority, &handle, core) != pdPASS) {
+        return false;
+    }
+    this->task_handle = handle;
+    return true;
+}
+
+void TickHub::stopTask() {
+    if (this->task_handle != nullptr) {
+        this->task_stop = true;
+        this->wake();
+        while (this->task_handle != nullptr) {
+            vTaskDelay(1);
+        }
+    }
+    if (this->wake_timer != nullptr) {
+        esp_timer_delete(this->wake_timer);
+        this->wake_timer = nullptr;
+    }
+}
+
+bool TickHub::isTaskRunning() const {
+    return this->task_handle != nullptr;
+}
+
+#else
+
+void TickHub::wake() {}
+
+#endif
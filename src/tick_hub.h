@@ -0,0 +1,181 @@
+#ifndef TICK_HUB_H
+#define TICK_HUB_H
+
+#include <Arduino.h>
+#include "delegate.hpp"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#endif
+
+
+/**
+ * @brief Run statistics for one TickHub task (all times in microseconds)
+ */
+struct TickTaskStats {
+    uint32_t runs;
+    uint32_t overruns;          // Runs whose execution took longer than the period
+    uint32_t missed;            // Periods skipped because the task started more than a full period late
+    uint32_t last_exec_us;
+    uint32_t max_exec_us;
+    uint32_t max_late_us;       // Worst start delay behind the scheduled time
+    uint64_t total_exec_us;
+
+    uint32_t avgExecUs() const { return this->runs ? (uint32_t)(this->total_exec_us / this->runs) : 0; }
+};
+
+
+/**
+ * @brief Cooperative scheduler that drives component callbacks at configured rates
+ * @note Register each periodic job (Button::tick, ShiftRegister::push_updates, ADS7828::updateAll, LIS3DH::fifoService, WifiManager::tick, ...) with a period and a priority, then either call tick() from loop() or start the hub's own FreeRTOS task (ESP32), optionally pinned to the second core.
+ * @note When several tasks are due, higher priority runs first (ties: the one furthest behind). Each due task runs at most once per tick(). Schedules are drift-free: the next run is one period after the previous due time, unless the task fell a whole period behind, in which case the missed periods are counted and skipped rather than run back-to-back.
+ * @note Callbacks run to completion; keep them short and non-blocking. Per-task execution time, lateness and overrun stats show which jobs over-poll or starve others.
+ */
+class TickHub {
+    public:
+        typedef Delegate<void()> TaskFunction;
+
+        static const uint8_t kMaxTasks = 16;
+        static const int8_t kInvalidTask = -1;
+        // Longest period: due times are compared as signed 32-bit microsecond offsets (about 35.8 min)
+        static const uint32_t kMaxPeriodUs = 0x7FFFFFFFUL;
+
+        TickHub();
+
+        /**
+         * @brief Destructor - stops the hub task (ESP32)
+         */
+        ~TickHub();
+
+        TickHub(const TickHub&) = delete;
+        TickHub& operator=(const TickHub&) = delete;
+
+        /**
+         * @brief Register a periodic task
+         * @param name Label used by printStats() (not copied, must outlive the task)
+         * @param function Callback to run; must fit in a Delegate (capture a pointer, e.g. [&button])
+         * @param period_us Interval between runs in microseconds (0 runs on every tick(); at most once per RTOS tick with startTask()); clamped to kMaxPeriodUs
+         * @param priority Higher runs first when several tasks are due (default 0)
+         * @return The task id, or kInvalidTask if the hub is full
+         * @note The first run is due immediately.
+         */
+        int8_t add(const char* name, const TaskFunction& function, uint32_t period_us, uint8_t priority = 0);
+
+        /**
+         * @brief Convenience overload taking the period in milliseconds (clamped to kMaxPeriodUs, like add())
+         */
+        int8_t addMs(const char* name, const TaskFunction& function, uint32_t period_ms, uint8_t priority = 0) {
+            const uint32_t period_us = period_ms > kMaxPeriodUs / 1000UL ? kMaxPeriodUs : period_ms * 1000UL;
+            return this->add(name, function, period_us, priority);
+        }
+
+        /**
+         * @brief Unregister a task (safe to call from inside its own callback)
+         */
+        void remove(int8_t id);
+
+        /**
+         * @brief Pause or resume a task; a resumed task is due immediately
+         * @note Safe to call from any task, e.g. to stop polling a device that went idle.
+         */
+        void setEnabled(int8_t id, bool enabled);
+        bool isEnabled(int8_t id) const;
+
+        /**
+         * @brief Change a task's period; takes effect from its next run (clamped to kMaxPeriodUs)
+         */
+        void setPeriod(int8_t id, uint32_t period_us);
+        uint32_t getPeriod(int8_t id) const;
+
+        /**
+         * @brief Run every task that is due - call this regularly from loop() when not using the hub task
+         * @return Microseconds until the next task is due (0 if one is already due, UINT32_MAX if none is enabled)
+         */
+        uint32_t tick();
+
+        /**
+         * @brief Returns the number of registered tasks
+         */
+        uint8_t size() const;
+
+        /**
+         * @brief Returns the stats for a task (zeroed for an invalid id)
+         */
+        const TickTaskStats& getStats(int8_t id) const;
+
+        /**
+         * @brief Returns a task's name, or nullptr for an invalid id
+         */
+        const char* getName(int8_t id) const;
+
+        /**
+         * @brief Percentage of wall time spent inside task callbacks since the last resetStats()
+         */
+        float getUtilization() const;
+
+        /**
+         * @brief Clear the stats of every task and restart the utilization window
+         */
+        void resetStats();
+
+        /**
+         * @brief Write one line per task: name, period, priority, runs, overruns, missed, avg/max exec and max lateness
+         */
+        void printStats(Print& out) const;
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        /**
+         * @brief Run the hub from its own FreeRTOS task instead of loop()
+         * @param priority FreeRTOS priority of the hub task (default 2, above loop())
+         * @param core Core to pin the task to (default tskNO_AFFINITY; 0 keeps it off the Arduino loop core on dual-core chips)
+         * @param stack_size Stack size in bytes; callbacks run on this stack
+         * @return true if the task is running
+         * @note The task sleeps until the next due time on a one-shot esp_timer, so wakeups are microsecond-accurate rather than tied to the RTOS tick.
+         * @note Do not also call tick() from loop() while the task runs. Register tasks before starting it, or from the hub task itself.
+         * @note When a pass leaves work due (a period of 0, or a job that overruns its period) the task still blocks for one RTOS tick, so such jobs run at most once per tick (1ms by default) in task mode.
+         */
+        bool startTask(UBaseType_t priority = 2, BaseType_t core = tskNO_AFFINITY, uint32_t stack_size = 4096);
+
+        /**
+         * @brief Stop the hub task (blocks until it has exited)
+         */
+        void stopTask();
+
+        bool isTaskRunning() const;
+        #endif
+
+    private:
+        struct Task {
+            TaskFunction function;
+            const char* name;
+            uint32_t period_us;
+            uint32_t next_due_us;
+            uint8_t priority;
+            bool used;
+            volatile bool enabled;
+            volatile bool restart;  // setEnabled(true): next run due immediately
+            TickTaskStats stats;
+        };
+
+        void run(uint8_t index, uint32_t now_us);
+        void wake();
+        bool validId(int8_t id) const;
+
+        Task tasks[kMaxTasks];
+        uint8_t count;
+        uint32_t stats_start_us;
+        uint64_t busy_us;
+
+        #if defined(ARDUINO_ARCH_ESP32)
+        static void taskEntry(void* arg);
+        static void timerCallback(void* arg);
+
+        volatile TaskHandle_t task_handle;
+        volatile bool task_stop;
+        esp_timer_handle_t wake_timer;
+        #endif
+};
+
+#endif // TICK_HUB_H
@@ -1,10 +1,17 @@
 
-#include <functional>
 #include "wifi_manager.h"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <Preferences.h>
+
+static const char* FAST_RECONNECT_NAMESPACE = "hubwifi";
+static const char* FAST_RECONNECT_KEY = "fast";
+static const uint32_t FAST_RECONNECT_MAGIC = 0x48574643; // "HWFC"
+#endif
+
 WifiManager::WifiManager(String ssid, String pass) {
     #ifdef ARDUINO_ARCH_ESP32
-    WiFi.onEvent(std::bind(&WifiManager::onEvent, this, std::placeholders::_1));
+    WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t) { this->onEvent(event); });
     #endif
     this->ssid = ssid;
     this->pass = pass;
@@ -17,18 +24,38 @@ void WifiManager::onEvent(WiFiEvent_t event) {
         case ARDUINO_EVENT_WIFI_STA_GOT_IP:
             this->_status = WifiStatus::CONNECTED;
             this->connected = true;
+            this->fastAttempt = false;
             this->ipAddress = WiFi.localIP().toString();
+            if (this->fastReconnect) {
+                this->storeFastReconnectCache();
+            }
+            this->noteConnected();
             if (this->logger) {
-                this->logger->println("WIFI CONNECTED; IP: " + this->ipAddress + "; RSSI: " + String(WiFi.RSSI()));
+                this->logger->println("WIFI CONNECTED; IP: " + this->ipAddress + "; RSSI: " + String(this->stats.rssiLast) + "; in " + String(this->stats.lastConnectMs) + "ms");
             }
             if (this->onConnectedCallback) {
                 this->onConnectedCallback(this->ipAddress);
             }
             break;
         case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            if (this->fastAttempt && !this->connected) {
+                // The cached AP/channel/lease didn't work - forget it and do a full scan + DHCP
+                this->fastAttempt = false;
+                if (this->logger) {
+                    this->logger->println("WIFI FAST RECONNECT FAILED; Falling back to full scan");
+                }
+                this->clearFastReconnectCache();
+                if (this->fastReuseLease) {
+                    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+                }
+                WiFi.begin(this->ssid, this->pass);
+                this->_status = WifiStatus::CONNECTING;
+                break;
+            }
             this->_status = WifiStatus::DISCONNECTED;
             this->connected = false;
             this->ipAddress = "";
+            this->noteDisconnected();
             if (this->logger) {
                 this->logger->println("WIFI DISCONNECTED; Disconnected from WiFi network");
             }
@@ -46,6 +73,7 @@ void WifiManager::onEvent(WiFiEvent_t event) {
         case ARDUINO_EVENT_WIFI_STA_LOST_IP: 
             this->connected = false;
             this->ipAddress = "";
+            this->noteDisconnected();
             break;
         default:
             break;
@@ -58,11 +86,101 @@ void WifiManager::begin() {
         return;
     }
 
+    #ifndef ARDUINO_ARCH_ESP32
+    if (this->_status == WifiStatus::CONNECTING) {
+        return;
+    }
+    // An explicit begin() starts a fresh attempt now, with the backoff reset
+    this->reconnectDelay = 0;
+    this->startConnect();
+    #else
+        if (this->logger) {
+            this->logger->println("WIFI CONNECTING; To network: " + this->ssid);
+        }
+        this->noteConnectStart();
+        this->applyPowerSave();
+        this->fastAttempt = false;
+        if (this->fastReconnect && this->loadFastReconnectCache()) {
+            // Skip the channel scan (and DHCP) by going straight to the last-good AP
+            if (this->fastReuseLease) {
+                WiFi.config(IPAddress(this->fastCache.ip), IPAddress(this->fastCache.gateway), IPAddress(this->fastCache.subnet),
+                            IPAddress(this->fastCache.dns1), IPAddress(this->fastCache.dns2));
+            }
+            WiFi.begin(this->ssid.c_str(), this->pass.c_str(), this->fastCache.channel, this->fastCache.bssid);
+            this->fastAttempt = true;
+        } else {
+            WiFi.begin(this->ssid, this->pass);
+        }
+        this->_status = WifiStatus::CONNECTING;
+    #endif
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+uint32_t WifiManager::ssidHash() {
+    // FNV-1a, so a cache written for another network is never used
+    uint32_t hash = 2166136261u;
+    for (unsigned int i = 0; i < this->ssid.length(); i++) {
+        hash = (hash ^ (uint8_t)this->ssid[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool WifiManager::loadFastReconnectCache() {
+    if (!this->fastCacheLoaded) {
+        this->fastCacheLoaded = true;
+        Preferences prefs;
+        if (prefs.begin(FAST_RECONNECT_NAMESPACE, true)) {
+            if (prefs.getBytes(FAST_RECONNECT_KEY, &this->fastCache, sizeof(this->fastCache)) != sizeof(this->fastCache)) {
+                this->fastCache.magic = 0;
+            }
+            prefs.end();
+        } else {
+            this->fastCache.magic = 0;
+        }
+    }
+    return this->fastCache.magic == FAST_RECONNECT_MAGIC && this->fastCache.ssidHash == this->ssidHash() && this->fastCache.channel != 0;
+}
+
+void WifiManager::storeFastReconnectCache() {
+    FastReconnectCache fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    fresh.magic = FAST_RECONNECT_MAGIC;
+    fresh.ssidHash = this->ssidHash();
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
+    fresh.channel = (uint8_t)WiFi.channel();
+    fresh.ip = (uint32_t)WiFi.localIP();
+    fresh.gateway = (uint32_t)WiFi.gatewayIP();
+    fresh.subnet = (uint32_t)WiFi.subnetMask();
+    fresh.dns1 = (uint32_t)WiFi.dnsIP(0);
+    fresh.dns2 = (uint32_t)WiFi.dnsIP(1);
+
+    // Only touch flash when something changed (a fast reconnect normally reproduces the same values)
+    if (this->fastCacheLoaded && memcmp(&fresh, &this->fastCache, sizeof(fresh)) == 0) {
+        return;
+    }
+    this->fastCache = fresh;
+    this->fastCacheLoaded = true;
+
+    Preferences prefs;
+    if (prefs.begin(FAST_RECONNECT_NAMESPACE, false)) {
+        prefs.putBytes(FAST_RECONNECT_KEY, &this->fastCache, sizeof(this->fastCache));
+        prefs.end();
+    }
+}
+#endif
+
+#ifndef ARDUINO_ARCH_ESP32
+void WifiManager::startConnect() {
+    this->reconnectPending = false;
+
     if (this->logger) {
         this->logger->println("WIFI CONNECTING; To network: " + this->ssid);
     }
 
-    #ifndef ARDUINO_ARCH_ESP32
     if (WiFi.status() == WL_NO_MODULE) {
         if (this->logger) {
             this->logger->println("WiFi module not avaialble - cannot connect to WiFi!");
@@ -71,45 +189,145 @@ void WifiManager::begin() {
         return;
     }
 
-    int connect_status = WiFi.begin(this->ssid.c_str(), this->pass.c_str());
-    unsigned long start_time = millis();
-    while (connect_status != WL_CONNECTED && millis() - start_time < 10000) {   // Max 10s to connect
-        delay(500);
-        connect_status = WiFi.status();
-        if (connect_status == WL_CONNECT_FAILED) {
-            if (this->logger) {
-                this->logger->println("Failed to connect to WiFi network: " + this->ssid);
-            }
-            this->_status = WifiStatus::ERROR;
-            return;
-        }
+    // WiFi.begin() polls the module for up to 10s; hand the credentials to the
+    // driver directly and let tick() watch the connection status instead
+    int8_t result;
+    if (this->pass.length() == 0) {
+        result = WiFiDrv::wifiSetNetwork(this->ssid.c_str(), this->ssid.length());
+    } else {
+        result = WiFiDrv::wifiSetPassphrase(this->ssid.c_str(), this->ssid.length(), this->pass.c_str(), this->pass.length());
     }
 
-    if (connect_status != WL_CONNECTED) {
-        if (this->logger) {
-            this->logger->println("Failed to connect to WiFi network: " + this->ssid);
-        }
-        this->_status = WifiStatus::ERROR;
-        return;
+    this->noteConnectStart();
+    this->attemptStart = millis();
+    this->_status = WifiStatus::CONNECTING;
+    if (result == WL_FAILURE) {
+        this->handleAttemptFailed();
     }
+}
 
+void WifiManager::handleConnected() {
     this->_status = WifiStatus::CONNECTED;
     this->connected = true;
+    this->reconnectDelay = 0;
+    this->lastLinkCheck = millis();
     this->ipAddress = WiFi.localIP().toString();
+    this->applyPowerSave();
+    this->noteConnected();
     if (this->logger) {
-        this->logger->println("WIFI CONNECTED; IP: " + this->ipAddress + "; RSSI: " + String(WiFi.RSSI()));
+        this->logger->println("WIFI CONNECTED; IP: " + this->ipAddress + "; RSSI: " + String(this->stats.rssiLast) + "; in " + String(this->stats.lastConnectMs) + "ms");
     }
     if (this->onConnectedCallback) {
         this->onConnectedCallback(this->ipAddress);
     }
-    #else
-        WiFi.begin(this->ssid, this->pass);
-        this->_status = WifiStatus::CONNECTING;
+}
+
+void WifiManager::handleAttemptFailed() {
+    if (this->logger) {
+        this->logger->println("Failed to connect to WiFi network: " + this->ssid);
+    }
+    // Abort the module's attempt so it can't complete behind our back
+    WiFi.disconnect();
+    this->_status = WifiStatus::ERROR;
+    if (this->autoReconnect) {
+        this->scheduleReconnect();
+    }
+}
+
+void WifiManager::handleLinkLost() {
+    this->_status = WifiStatus::DISCONNECTED;
+    this->connected = false;
+    this->ipAddress = "";
+    this->noteDisconnected();
+    if (this->logger) {
+        this->logger->println("WIFI DISCONNECTED; Disconnected from WiFi network");
+    }
+    if (this->onDisconnectedCallback) {
+        this->onDisconnectedCallback();
+    }
+    if (this->autoReconnect) {
+        this->scheduleReconnect();
+    }
+}
+
+void WifiManager::scheduleReconnect() {
+    // Exponential backoff: min, 2*min, 4*min ... capped at max
+    if (this->reconnectDelay < this->reconnectBackoffMin) {
+        this->reconnectDelay = this->reconnectBackoffMin;
+    } else if (this->reconnectDelay >= this->reconnectBackoffMax / 2) {
+        this->reconnectDelay = this->reconnectBackoffMax;
+    } else {
+        this->reconnectDelay *= 2;
+    }
+    this->reconnectAt = millis() + this->reconnectDelay;
+    this->reconnectPending = true;
+    if (this->logger) {
+        this->logger->println("WIFI RECONNECT; Retrying in " + String(this->reconnectDelay) + "ms");
+    }
+}
+#endif
+
+void WifiManager::tick() {
+    const unsigned long now = millis();
+    if (this->connected && this->rssiInterval > 0 && now - this->lastRssiSample >= this->rssiInterval) {
+        this->sampleRssi();
+    }
+
+    #ifndef ARDUINO_ARCH_ESP32
+    switch (this->_status) {
+        case WifiStatus::CONNECTING: {
+            const uint8_t connect_status = WiFi.status();
+            if (connect_status == WL_CONNECTED) {
+                this->handleConnected();
+            } else if (connect_status == WL_CONNECT_FAILED || now - this->attemptStart >= this->connectTimeout) {
+                this->handleAttemptFailed();
+            }
+            break;
+        }
+        case WifiStatus::CONNECTED:
+            // Status is an SPI round trip to the module, so only check the link periodically
+            if (now - this->lastLinkCheck >= 500) {
+                this->lastLinkCheck = now;
+                if (WiFi.status() != WL_CONNECTED) {
+                    this->handleLinkLost();
+                }
+            }
+            break;
+        case WifiStatus::DISCONNECTING:
+            if (WiFi.status() != WL_CONNECTED) {
+                this->_status = WifiStatus::DISCONNECTED;
+                this->noteDisconnected();
+                if (this->onDisconnectedCallback) {
+                    this->onDisconnectedCallback();
+                }
+            }
+            break;
+        case WifiStatus::DISCONNECTED:
+        case WifiStatus::ERROR:
+            if (this->reconnectPending && (long)(now - this->reconnectAt) >= 0) {
+                if (this->autoReconnect) {
+                    this->startConnect();
+                } else {
+                    this->reconnectPending = false;
+                }
+            }
+            break;
+        default:
+            break;
+    }
     #endif
 }
 
 void WifiManager::disconnect() {
     WiFi.disconnect();
+    #ifndef ARDUINO_ARCH_ESP32
+    this->reconnectPending = false;
+    if (this->connected) {
+        this->connected = false;
+        this->ipAddress = "";
+        this->noteDisconnected();
+    }
+    #endif
     this->_status = WifiStatus::DISCONNECTING;
 }
 
@@ -117,14 +335,22 @@ bool WifiManager::isConnected() {
     return this->connected;
 }
 
-void WifiManager::onConnected(std::function<void(String)> callback) {
+void WifiManager::onConnected(Delegate<void(String)> callback) {
     this->onConnectedCallback = callback;
 }
 
-void WifiManager::onDisconnected(std::function<void()> callback) {
+void WifiManager::onConnected(void (*callback)(void*, String), void* context) {
+    this->onConnectedCallback = Delegate<void(String)>(callback, context);
+}
+
+void WifiManager::onDisconnected(Delegate<void()> callback) {
     this->onDisconnectedCallback = callback;
 }
 
+void WifiManager::onDisconnected(void (*callback)(void*), void* context) {
+    this->onDisconnectedCallback = Delegate<void()>(callback, context);
+}
+
 void WifiManager::setAutoReconnect(bool autoReconnect) {
     this->autoReconnect = autoReconnect;
 }
@@ -133,6 +359,45 @@ bool WifiManager::isAutoReconnect() {
     return this->autoReconnect;
 }
 
+void WifiManager::setConnectTimeout(unsigned long timeoutMs) {
+    this->connectTimeout = timeoutMs;
+}
+
+void WifiManager::setFastReconnect(bool enabled, bool reuseLease) {
+    #ifdef ARDUINO_ARCH_ESP32
+    this->fastReconnect = enabled;
+    this->fastReuseLease = reuseLease;
+    #else
+    (void)enabled;
+    (void)reuseLease;
+    #endif
+}
+
+bool WifiManager::isFastReconnect() {
+    #ifdef ARDUINO_ARCH_ESP32
+    return this->fastReconnect;
+    #else
+    return false;
+    #endif
+}
+
+void WifiManager::clearFastReconnectCache() {
+    #ifdef ARDUINO_ARCH_ESP32
+    memset(&this->fastCache, 0, sizeof(this->fastCache));
+    this->fastCacheLoaded = true;
+    Preferences prefs;
+    if (prefs.begin(FAST_RECONNECT_NAMESPACE, false)) {
+        prefs.remove(FAST_RECONNECT_KEY);
+        prefs.end();
+    }
+    #endif
+}
+
+void WifiManager::setReconnectBackoff(unsigned long minMs, unsigned long maxMs) {
+    this->reconnectBackoffMin = minMs;
+    this->reconnectBackoffMax = maxMs < minMs ? minMs : maxMs;
+}
+
 WifiStatus WifiManager::status() {
     return this->_status;
 }
@@ -142,7 +407,122 @@ String WifiManager::address() {
 }
 
 long WifiManager::strength() {
-    return WiFi.RSSI();
+    if (!this->connected) {
+        return WiFi.RSSI();
+    }
+    return this->sampleRssi();
+}
+
+long WifiManager::sampleRssi() {
+    const long rssi = WiFi.RSSI();
+    this->lastRssiSample = millis();
+    if (rssi == 0) {
+        return rssi;  // Not associated - don't pollute the average
+    }
+    if (this->stats.rssiSamples == 0) {
+        this->stats.rssiAverage = rssi;
+        this->stats.rssiMin = rssi;
+        this->stats.rssiMax = rssi;
+    } else {
+        this->stats.rssiAverage += this->rssiAlpha * (rssi - this->stats.rssiAverage);
+        if (rssi < this->stats.rssiMin) this->stats.rssiMin = rssi;
+        if (rssi > this->stats.rssiMax) this->stats.rssiMax = rssi;
+    }
+    this->stats.rssiLast = rssi;
+    this->stats.rssiSamples++;
+    return rssi;
+}
+
+void WifiManager::noteConnectStart() {
+    if (!this->connectTiming) {
+        this->connectTiming = true;
+        this->connectStart = millis();
+    }
+}
+
+void WifiManager::noteConnected() {
+    const unsigned long now = millis();
+    if (this->connectTiming) {
+        this->connectTiming = false;
+        this->stats.lastConnectMs = now - this->connectStart;
+    }
+    if (!this->sessionActive) {
+        this->sessionActive = true;
+        this->sessionStart = now;
+        if (this->stats.connects > 0) {
+            this->stats.reconnects++;
+        }
+        this->stats.connects++;
+    }
+    this->sampleRssi();
+}
+
+void WifiManager::noteDisconnected() {
+    if (!this->sessionActive) {
+        return;
+    }
+    this->sessionActive = false;
+    const unsigned long session = millis() - this->sessionStart;
+    this->stats.connectedMs += session;
+    this->stats.lastSessionMs = session;
+    this->stats.disconnects++;
+}
+
+void WifiManager::applyPowerSave() {
+    #ifdef ARDUINO_ARCH_ESP32
+    switch (this->powerSave) {
+        case WifiPowerSave::NONE:
+            WiFi.setSleep(WIFI_PS_NONE);
+            break;
+        case WifiPowerSave::MIN_MODEM:
+            WiFi.setSleep(WIFI_PS_MIN_MODEM);
+            break;
+        case WifiPowerSave::MAX_MODEM:
+            WiFi.setSleep(WIFI_PS_MAX_MODEM);
+            break;
+    }
+    #else
+    // NINA firmware has a single low power mode
+    if (this->powerSave == WifiPowerSave::NONE) {
+        WiFi.noLowPowerMode();
+    } else {
+        WiFi.lowPowerMode();
+    }
+    #endif
+}
+
+void WifiManager::setPowerSave(WifiPowerSave mode) {
+    this->powerSave = mode;
+    this->applyPowerSave();
+}
+
+WifiPowerSave WifiManager::getPowerSave() {
+    return this->powerSave;
+}
+
+void WifiManager::setRssiSampling(unsigned long intervalMs, float alpha) {
+    this->rssiInterval = intervalMs;
+    if (alpha > 0.0f && alpha <= 1.0f) {
+        this->rssiAlpha = alpha;
+    }
+}
+
+WifiLinkStats WifiManager::linkStats() {
+    WifiLinkStats snapshot = this->stats;
+    if (this->sessionActive) {
+        const unsigned long session = millis() - this->sessionStart;
+        snapshot.connectedMs += session;
+        snapshot.lastSessionMs = session;
+    }
+    return snapshot;
+}
+
+void WifiManager::resetLinkStats() {
+    this->stats = WifiLinkStats();
+    if (this->sessionActive) {
+        // Keep accounting for the current session from now on
+        this->sessionStart = millis();
+    }
 }
 
 void WifiManager::setLogger(Print& logger) {
@@ -2,7 +2,7 @@
 #define HUB_WIFI_MANAGER_H
 
 #include <Arduino.h>
-#include <functional>
+#include "delegate.hpp"
 
 #if defined(ARDUINO_ARCH_ESP32)
 #include <WiFi.h>
@@ -21,10 +21,31 @@ enum class WifiStatus {
     ERROR
 };
 
+// Modem sleep policy between DTIM beacons: trade latency for power
+enum class WifiPowerSave {
+    NONE,       // Radio always on - lowest latency, highest current
+    MIN_MODEM,  // Wake every DTIM (default on ESP32)
+    MAX_MODEM   // Wake every listen interval - lowest power, highest latency
+};
+
+struct WifiLinkStats {
+    float rssiAverage = 0;            // EWMA of RSSI samples (dBm)
+    long rssiLast = 0;
+    long rssiMin = 0;
+    long rssiMax = 0;
+    uint32_t rssiSamples = 0;
+    uint32_t connects = 0;
+    uint32_t reconnects = 0;          // Connections after the first one
+    uint32_t disconnects = 0;         // Connected sessions that ended
+    unsigned long connectedMs = 0;    // Total time connected, including the current session
+    unsigned long lastSessionMs = 0;  // Length of the current (or last) connected session
+    unsigned long lastConnectMs = 0;  // Time from starting the connection attempt to connected (latest connection)
+};
+
 class WifiManager {
     private:
-        std::function<void(String)> onConnectedCallback;
-        std::function<void()> onDisconnectedCallback;
+        Delegate<void(String)> onConnectedCallback;
+        Delegate<void()> onDisconnectedCallback;
         bool connected = false;
         bool autoReconnect = true;
         String ipAddress;
@@ -32,19 +53,87 @@ class WifiManager {
         String pass;
         WifiStatus _status = WifiStatus::IDLE;
         Print* logger = nullptr;
+        unsigned long connectTimeout = 10000;
+        unsigned long reconnectBackoffMin = 1000;
+        unsigned long reconnectBackoffMax = 60000;
+        WifiPowerSave powerSave = WifiPowerSave::MIN_MODEM;
+        WifiLinkStats stats;
+        float rssiAlpha = 0.2f;
+        unsigned long rssiInterval = 1000;
+        unsigned long lastRssiSample = 0;
+        unsigned long sessionStart = 0;
+        unsigned long connectStart = 0;
+        bool sessionActive = false;
+        bool connectTiming = false;
+
+        void applyPowerSave();
+        void noteConnectStart();
+        void noteConnected();
+        void noteDisconnected();
+        long sampleRssi();
 
         #ifdef ARDUINO_ARCH_ESP32
+        // Last-good association and lease, persisted to NVS for fast reconnects
+        struct FastReconnectCache {
+            uint32_t magic;
+            uint32_t ssidHash;
+            uint8_t bssid[6];
+            uint8_t channel;
+            uint8_t reserved;
+            uint32_t ip;
+            uint32_t gateway;
+            uint32_t subnet;
+            uint32_t dns1;
+            uint32_t dns2;
+        };
+        FastReconnectCache fastCache = {};
+        bool fastReconnect = false;
+        bool fastReuseLease = true;
+        bool fastCacheLoaded = false;
+        bool fastAttempt = false;
+
         void onEvent(WiFiEvent_t event);
+        bool loadFastReconnectCache();
+        void storeFastReconnectCache();
+        uint32_t ssidHash();
+        #else
+        // Connection state machine, advanced by tick()
+        unsigned long attemptStart = 0;
+        unsigned long lastLinkCheck = 0;
+        unsigned long reconnectAt = 0;
+        unsigned long reconnectDelay = 0;
+        bool reconnectPending = false;
+
+        void startConnect();
+        void handleConnected();
+        void handleAttemptFailed();
+        void handleLinkLost();
+        void scheduleReconnect();
         #endif
     public:
         WifiManager(String ssid, String pass);
         void begin();
+        void tick();  // Call from loop() on every platform: it also takes the periodic RSSI sample
         void disconnect();
         bool isConnected();
-        void onConnected(std::function<void(String)> callback);
-        void onDisconnected(std::function<void()> callback);
+        void onConnected(Delegate<void(String)> callback);
+        void onConnected(void (*callback)(void*, String), void* context);
+        void onDisconnected(Delegate<void()> callback);
+        void onDisconnected(void (*callback)(void*), void* context);
         void setAutoReconnect(bool autoReconnect);
         bool isAutoReconnect();
+        void setConnectTimeout(unsigned long timeoutMs);
+        void setReconnectBackoff(unsigned long minMs, unsigned long maxMs);
+        void setFastReconnect(bool enabled, bool reuseLease = true);
+        bool isFastReconnect();
+        void clearFastReconnectCache();
+        void setPowerSave(WifiPowerSave mode);
+        WifiPowerSave getPowerSave();
+        // RSSI has no WiFi event: it is sampled on connect, by strength() and by tick() every intervalMs.
+        // Without regular tick() calls the RSSI fields of linkStats() stop updating, even on ESP32.
+        void setRssiSampling(unsigned long intervalMs, float alpha = 0.2f);
+        WifiLinkStats linkStats();
+        void resetLinkStats();
         void setLogger(Print& logger);
         WifiStatus status();
         String address();